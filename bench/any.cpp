@@ -0,0 +1,80 @@
+#include "any.hpp"
+#include "bench.hpp"
+#include <any>
+#include <array>
+#include <string>
+
+// `int` fits the small buffer of both std::any and mystd::any, `large`
+// never does
+
+using large = std::array<long, 8>;
+
+template <class Any, class Cast>
+auto any_benchmarks(bench::suite &s, const std::string &name, Cast cast)
+    -> void {
+    s.run("construct/int/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Any a(static_cast<int>(i));
+            bench::do_not_optimize(a);
+        }
+    });
+    s.run("construct/large/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Any a(large{static_cast<long>(i)});
+            bench::do_not_optimize(a);
+        }
+    });
+
+    Any small_source(42);
+    Any large_source(large{});
+    s.run("copy/int/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Any copy(small_source);
+            bench::do_not_optimize(copy);
+        }
+    });
+    s.run("copy/large/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Any copy(large_source);
+            bench::do_not_optimize(copy);
+        }
+    });
+    s.run("move/int/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Any tmp(std::move(small_source));
+            bench::do_not_optimize(tmp);
+            small_source = std::move(tmp);
+        }
+    });
+
+    // a successful and a failing cast
+    s.run("cast/" + name, [&](std::size_t n) {
+        int sum = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            bench::do_not_optimize(small_source);
+            if (auto p = cast.template operator()<int>(&small_source))
+                sum += *p;
+        }
+        bench::do_not_optimize(sum);
+    });
+    s.run("bad_cast/" + name, [&](std::size_t n) {
+        int sum = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            bench::do_not_optimize(small_source);
+            if (auto p = cast.template operator()<long>(&small_source))
+                sum += static_cast<int>(*p);
+        }
+        bench::do_not_optimize(sum);
+    });
+}
+
+auto main(int argc, char **argv) -> int {
+    bench::suite s("any", argc, argv);
+
+    any_benchmarks<mystd::any>(
+        s, "mystd::any",
+        []<class T>(mystd::any *a) { return any_cast<T>(a); });
+    any_benchmarks<std::any>(s, "std::any", []<class T>(std::any *a) {
+        return std::any_cast<T>(a);
+    });
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+// a tiny timing harness for the benchmarks in this directory
+//  - `suite::run(name, body)`: `body(n)` performs n operations
+//  - n is doubled until one repetition takes at least `min_time`, then the
+//    body is repeated `repetitions` times with that n, and the median and the
+//    minimum time per operation are reported
+//  - results are written to stdout as JSON when the suite is destroyed
+//  - the first command line argument, if any, only runs the benchmarks whose
+//    name contains it
+namespace bench {
+
+// forces value to be computed and kept in memory
+template <class T> inline auto do_not_optimize(T &&value) -> void {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// forces pending writes to memory
+inline auto clobber_memory() -> void { asm volatile("" : : : "memory"); }
+
+struct result {
+    std::string name;
+    std::size_t iterations; // operations per repetition
+    double ns_per_op;       // median over the repetitions
+    double min_ns_per_op;
+};
+
+class suite {
+  public:
+    static constexpr auto min_time = std::chrono::milliseconds(20);
+    static constexpr std::size_t max_iterations = std::size_t{1} << 30;
+    static constexpr int repetitions = 5;
+
+    suite(std::string name, int argc, char **argv) : _name(std::move(name)) {
+        if (argc > 1)
+            _filter = argv[1];
+    }
+
+    suite(const suite &) = delete;
+    auto operator=(const suite &) -> suite & = delete;
+
+    ~suite() { report(); }
+
+    template <class F> auto run(std::string name, F body) -> void {
+        if (name.find(_filter) == std::string::npos)
+            return;
+
+        std::size_t n = 1;
+        while (n < max_iterations && time(body, n) < min_time)
+            n *= 2;
+
+        std::vector<double> samples;
+        for (int i = 0; i < repetitions; i++) {
+            auto elapsed = std::chrono::duration<double, std::nano>(
+                time(body, n));
+            samples.push_back(elapsed.count() / static_cast<double>(n));
+        }
+        std::sort(samples.begin(), samples.end());
+        _results.push_back(
+            {std::move(name), n, samples[repetitions / 2], samples.front()});
+    }
+
+  private:
+    std::string _name;
+    std::string _filter;
+    std::vector<result> _results;
+
+    template <class F>
+    static auto time(F &body, std::size_t n) -> std::chrono::nanoseconds {
+        auto start = std::chrono::steady_clock::now();
+        body(n);
+        clobber_memory();
+        return std::chrono::steady_clock::now() - start;
+    }
+
+    auto report() const -> void {
+        std::printf("{\n  \"suite\": \"%s\",\n", _name.c_str());
+        std::printf("  \"compiler\": \"%s\",\n", __VERSION__);
+        std::printf("  \"benchmarks\": [");
+        for (std::size_t i = 0; i < _results.size(); i++) {
+            const auto &r = _results[i];
+            std::printf("%s\n    {\"name\": \"%s\", \"iterations\": %zu, "
+                        "\"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f}",
+                        i == 0 ? "" : ",", r.name.c_str(), r.iterations,
+                        r.ns_per_op, r.min_ns_per_op);
+        }
+        std::printf("\n  ]\n}\n");
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,124 @@
+#include "bench.hpp"
+#include "functional.hpp"
+#include <array>
+#include <functional>
+#include <string>
+
+// calls through a type-erased callable that the optimizer cannot see through,
+// compared with a direct call
+
+struct adder {
+    int step;
+    auto operator()(int x) -> int { return x + step; }
+};
+
+[[gnu::noinline]] auto add_one(int x) -> int { return x + 1; }
+
+[[gnu::noinline]] auto length(const std::string &s) -> std::size_t {
+    return s.size();
+}
+
+template <class F>
+[[gnu::noinline]] auto call_n(F f, std::size_t n) -> int {
+    int acc = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        acc = f(acc);
+        bench::do_not_optimize(acc);
+    }
+    return acc;
+}
+
+auto main(int argc, char **argv) -> int {
+    bench::suite s("functional", argc, argv);
+
+    adder add{1};
+    s.run("call/direct", [&](std::size_t n) {
+        bench::do_not_optimize(call_n<adder &>(add, n));
+    });
+    s.run("call/mystd::function_ref", [&](std::size_t n) {
+        bench::do_not_optimize(
+            call_n(mystd::function_ref<int(int)>(add), n));
+    });
+    s.run("call/std::function", [&](std::size_t n) {
+        bench::do_not_optimize(call_n(std::function<int(int)>(add), n));
+    });
+    s.run("call/function pointer", [&](std::size_t n) {
+        auto volatile f = &add_one;
+        bench::do_not_optimize(call_n(f, n));
+    });
+    s.run("call/mystd::function_ref nontype", [&](std::size_t n) {
+        bench::do_not_optimize(call_n(
+            mystd::function_ref<int(int)>(mystd::nontype<&add_one>), n));
+    });
+    s.run("call/mystd::move_only_function", [&](std::size_t n) {
+        mystd::move_only_function<int(int)> f(add);
+        bench::do_not_optimize(call_n<decltype(f) &>(f, n));
+    });
+    s.run("call/mystd::inplace_function", [&](std::size_t n) {
+        bench::do_not_optimize(
+            call_n(mystd::inplace_function<int(int)>(add), n));
+    });
+
+    // a string argument is copied by operator() of either wrapper, only
+    // std::function copies it a second time into its thunk
+    std::string word(32, 'x');
+    s.run("call-string/mystd::function_ref", [&](std::size_t n) {
+        mystd::function_ref<std::size_t(std::string)> f(length);
+        for (std::size_t i = 0; i < n; i++)
+            bench::do_not_optimize(f(word));
+    });
+    s.run("call-string/std::function", [&](std::size_t n) {
+        std::function<std::size_t(std::string)> f(length);
+        bench::do_not_optimize(f);
+        for (std::size_t i = 0; i < n; i++)
+            bench::do_not_optimize(f(word));
+    });
+
+    s.run("construct/mystd::function_ref", [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            mystd::function_ref<int(int)> f(add);
+            bench::do_not_optimize(f);
+        }
+    });
+    s.run("construct/std::function", [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            std::function<int(int)> f(add);
+            bench::do_not_optimize(f);
+        }
+    });
+    s.run("construct/mystd::move_only_function", [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            mystd::move_only_function<int(int)> f(add);
+            bench::do_not_optimize(f);
+        }
+    });
+    s.run("construct/mystd::inplace_function", [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            mystd::inplace_function<int(int)> f(add);
+            bench::do_not_optimize(f);
+        }
+    });
+
+    // a capture of 64 bytes, larger than the buffer of std::function
+    std::array<int, 16> table{};
+    table[3] = 1;
+    auto lookup = [table](int x) { return x + table[3]; };
+    s.run("construct-large/std::function", [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            std::function<int(int)> f(lookup);
+            bench::do_not_optimize(f);
+        }
+    });
+    s.run("construct-large/mystd::move_only_function", [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            mystd::move_only_function<int(int)> f(lookup);
+            bench::do_not_optimize(f);
+        }
+    });
+    s.run("construct-large/mystd::inplace_function", [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            mystd::inplace_function<int(int), sizeof(lookup)> f(lookup);
+            bench::do_not_optimize(f);
+        }
+    });
+}
@@ -0,0 +1,66 @@
+#include "bench.hpp"
+#include "mdspan.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// the same kernels over a 1024 x 1024 matrix of floats (4 MiB) in each
+// layout, one operation is one pass over the matrix
+//  - `rows` walks the matrix row by row, `cols` column by column
+//  - `hand-written` is the index math of layout_right over a raw pointer
+
+constexpr int dim = 1024;
+
+using matrix_extents = mystd::extents<int, dim, dim>;
+
+template <class M> [[gnu::noinline]] auto sum_rows(M m) -> float {
+    float total = 0;
+    for (int i = 0; i < m.extent(0); i++)
+        for (int j = 0; j < m.extent(1); j++)
+            total += m[i, j];
+    return total;
+}
+
+template <class M> [[gnu::noinline]] auto sum_cols(M m) -> float {
+    float total = 0;
+    for (int j = 0; j < m.extent(1); j++)
+        for (int i = 0; i < m.extent(0); i++)
+            total += m[i, j];
+    return total;
+}
+
+template <class Layout>
+auto layout_benchmarks(bench::suite &s, const std::string &name,
+                       std::vector<float> &data) -> void {
+    mystd::mdspan<float, matrix_extents, Layout> m(data.data());
+    s.run("rows/" + name, [&](std::size_t n) {
+        for (std::size_t k = 0; k < n; k++)
+            bench::do_not_optimize(sum_rows(m));
+    });
+    s.run("cols/" + name, [&](std::size_t n) {
+        for (std::size_t k = 0; k < n; k++)
+            bench::do_not_optimize(sum_cols(m));
+    });
+}
+
+auto main(int argc, char **argv) -> int {
+    bench::suite s("mdspan", argc, argv);
+
+    std::vector<float> data(dim * dim, 1.0f);
+
+    s.run("rows/hand-written", [&](std::size_t n) {
+        for (std::size_t k = 0; k < n; k++) {
+            float total = 0;
+            const float *p = data.data();
+            bench::do_not_optimize(p);
+            for (int i = 0; i < dim; i++)
+                for (int j = 0; j < dim; j++)
+                    total += p[i * dim + j];
+            bench::do_not_optimize(total);
+        }
+    });
+    layout_benchmarks<mystd::layout_right>(s, "layout_right", data);
+    layout_benchmarks<mystd::layout_left>(s, "layout_left", data);
+    layout_benchmarks<mystd::layout_tiled<16, 16>>(s, "layout_tiled<16, 16>",
+                                                   data);
+}
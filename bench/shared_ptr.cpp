@@ -0,0 +1,231 @@
+#include "bench.hpp"
+#include "memory.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// refcount traffic: `copy` is one increment and one decrement of the shared
+// count, `copy_contended` does the same from several threads on one object,
+// `owner_contended` times the thread that created the object while the other
+// threads copy it, `snapshot_load` loads a published pointer while another
+// thread keeps replacing it, `drop_last` times the thread that drops the last
+// reference to an object with an expensive destructor
+
+template <class Ptr, class MakeShared>
+auto single_threaded(bench::suite &s, const std::string &name,
+                     MakeShared make_shared) -> void {
+    s.run("make_shared/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            auto p = make_shared(static_cast<int>(i));
+            bench::do_not_optimize(p);
+        }
+    });
+    s.run("new_and_adopt/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Ptr p(new int(static_cast<int>(i)));
+            bench::do_not_optimize(p);
+        }
+    });
+
+    auto source = make_shared(42);
+    s.run("copy/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Ptr copy(source);
+            bench::do_not_optimize(copy);
+        }
+    });
+    s.run("move/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Ptr tmp(std::move(source));
+            bench::do_not_optimize(tmp);
+            source = std::move(tmp);
+        }
+    });
+}
+
+// n copies per thread, so the reported time is per copy of a single thread
+template <class Ptr, class MakeShared>
+auto contended(bench::suite &s, const std::string &name,
+               MakeShared make_shared, int threads) -> void {
+    auto source = make_shared(42);
+    s.run("copy_contended/threads:" + std::to_string(threads) + "/" + name,
+          [&](std::size_t n) {
+              std::vector<std::thread> workers;
+              for (int t = 0; t < threads; t++) {
+                  workers.emplace_back([&] {
+                      for (std::size_t i = 0; i < n; i++) {
+                          Ptr copy(source);
+                          bench::do_not_optimize(copy);
+                      }
+                  });
+              }
+              for (auto &w : workers)
+                  w.join();
+          });
+}
+
+// the main thread makes n copies while threads - 1 workers copy until it is
+// done, so the reported time is per copy of the owner
+template <class Ptr, class MakeShared>
+auto owner_contended(bench::suite &s, const std::string &name,
+                     MakeShared make_shared, int threads) -> void {
+    auto source = make_shared(42);
+    s.run("owner_contended/threads:" + std::to_string(threads) + "/" + name,
+          [&](std::size_t n) {
+              std::atomic<bool> done{false};
+              std::vector<std::thread> workers;
+              for (int t = 1; t < threads; t++) {
+                  workers.emplace_back([&] {
+                      while (!done.load(std::memory_order_relaxed)) {
+                          Ptr copy(source);
+                          bench::do_not_optimize(copy);
+                      }
+                  });
+              }
+              for (std::size_t i = 0; i < n; i++) {
+                  Ptr copy(source);
+                  bench::do_not_optimize(copy);
+              }
+              done = true;
+              for (auto &w : workers)
+                  w.join();
+          });
+}
+
+// the baseline that atomic_shared_ptr replaces
+struct locked_shared_ptr {
+    mutable std::mutex mutex;
+    mystd::shared_ptr<int> sp;
+
+    auto load() const -> mystd::shared_ptr<int> {
+        std::lock_guard lock(mutex);
+        return sp;
+    }
+    auto store(mystd::shared_ptr<int> desired) -> void {
+        std::lock_guard lock(mutex);
+        sp.swap(desired);
+    }
+};
+
+// n loads from each of `threads` readers, with one writer storing a new
+// pointer every 64 loads of the first reader
+template <class Atomic, class MakeShared>
+auto snapshot_load(bench::suite &s, const std::string &name,
+                   MakeShared make_shared, int threads) -> void {
+    Atomic published;
+    published.store(make_shared(0));
+    s.run("snapshot_load/threads:" + std::to_string(threads) + "/" + name,
+          [&](std::size_t n) {
+              std::atomic<std::size_t> progress{0};
+              std::atomic<bool> done{false};
+              std::thread writer([&] {
+                  int version = 0;
+                  std::size_t last = 0;
+                  while (!done.load(std::memory_order_relaxed)) {
+                      auto now = progress.load(std::memory_order_relaxed);
+                      if (now - last >= 64) {
+                          published.store(make_shared(++version));
+                          last = now;
+                      }
+                      std::this_thread::yield();
+                  }
+              });
+              std::vector<std::thread> readers;
+              for (int t = 0; t < threads; t++) {
+                  readers.emplace_back([&, t] {
+                      for (std::size_t i = 0; i < n; i++) {
+                          auto sp = published.load();
+                          bench::do_not_optimize(sp);
+                          if (t == 0)
+                              progress.store(i, std::memory_order_relaxed);
+                      }
+                  });
+              }
+              for (auto &r : readers)
+                  r.join();
+              done = true;
+              writer.join();
+          });
+}
+
+// an object whose destructor takes about a microsecond
+struct expensive_to_destroy {
+    std::vector<int> data = std::vector<int>(256, 1);
+
+    ~expensive_to_destroy() {
+        for (int round = 0; round < 16; round++) {
+            for (auto &x : data)
+                x = x * 3 + round;
+            bench::clobber_memory();
+        }
+    }
+};
+
+// n objects created and dropped by one thread, destroyed either by that
+// thread or by the reclaimer thread
+//  - only meaningful with a spare core for the reclaimer thread
+auto drop_last(bench::suite &s) -> void {
+    s.run("drop_last/delete", [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            mystd::shared_ptr<expensive_to_destroy> p(
+                new expensive_to_destroy{});
+            bench::do_not_optimize(p);
+        }
+    });
+    s.run("drop_last/deferred_delete", [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            mystd::shared_ptr<expensive_to_destroy> p(
+                new expensive_to_destroy{},
+                mystd::deferred_delete<expensive_to_destroy>{});
+            bench::do_not_optimize(p);
+        }
+    });
+    mystd::reclaimer::instance().drain();
+}
+
+auto main(int argc, char **argv) -> int {
+    bench::suite s("shared_ptr", argc, argv);
+
+    auto mystd_make = [](int i) { return mystd::make_shared<int>(i); };
+    auto std_make = [](int i) { return std::make_shared<int>(i); };
+    auto local_make = [](int i) { return mystd::make_local_shared<int>(i); };
+    auto biased_make = [](int i) { return mystd::make_biased_shared<int>(i); };
+
+    single_threaded<mystd::shared_ptr<int>>(s, "mystd::shared_ptr",
+                                            mystd_make);
+    single_threaded<std::shared_ptr<int>>(s, "std::shared_ptr", std_make);
+    single_threaded<mystd::local_shared_ptr<int>>(s, "mystd::local_shared_ptr",
+                                                  local_make);
+    single_threaded<mystd::biased_shared_ptr<int>>(
+        s, "mystd::biased_shared_ptr", biased_make);
+
+    for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+        contended<mystd::shared_ptr<int>>(s, "mystd::shared_ptr", mystd_make,
+                                          threads);
+        contended<std::shared_ptr<int>>(s, "std::shared_ptr", std_make,
+                                        threads);
+        contended<mystd::biased_shared_ptr<int>>(
+            s, "mystd::biased_shared_ptr", biased_make, threads);
+
+        owner_contended<mystd::shared_ptr<int>>(s, "mystd::shared_ptr",
+                                                mystd_make, threads);
+        owner_contended<std::shared_ptr<int>>(s, "std::shared_ptr", std_make,
+                                              threads);
+        owner_contended<mystd::biased_shared_ptr<int>>(
+            s, "mystd::biased_shared_ptr", biased_make, threads);
+    }
+
+    for (int threads : {1, 4, 16}) {
+        snapshot_load<mystd::atomic_shared_ptr<int>>(
+            s, "mystd::atomic_shared_ptr", mystd_make, threads);
+        snapshot_load<std::atomic<std::shared_ptr<int>>>(
+            s, "std::atomic<std::shared_ptr>", std_make, threads);
+        snapshot_load<locked_shared_ptr>(s, "mutex+mystd::shared_ptr",
+                                         mystd_make, threads);
+    }
+
+    drop_last(s);
+}
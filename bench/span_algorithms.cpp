@@ -0,0 +1,135 @@
+#include "bench.hpp"
+#include "span_algorithms.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// one operation is one pass over a column of 16384 elements that fits in L2,
+// for the std algorithms and for mystd at every simd level the CPU supports
+//  - find and search look for a value that is not there, mismatch finds the
+//    last element
+
+constexpr std::size_t column_size = 16384;
+
+// runs body as "<name>/mystd <level>" for every supported level
+template <class F>
+auto each_level(bench::suite &s, const std::string &name, F body) -> void {
+    using mystd::detail::simd_level;
+    const auto best = mystd::detail::detect_simd_level();
+    const std::pair<simd_level, const char *> levels[] = {
+        {simd_level::scalar, "scalar"},
+        {simd_level::sse2, "sse2"},
+        {simd_level::avx2, "avx2"}};
+    for (auto [level, level_name] : levels) {
+        if (level > best)
+            break;
+        s.run(name + "/mystd " + level_name, [&](std::size_t n) {
+            mystd::detail::active_simd_level = level;
+            body(n);
+        });
+    }
+    mystd::detail::active_simd_level = best;
+}
+
+template <class T>
+auto column_benchmarks(bench::suite &s, const std::string &type) -> void {
+    std::vector<T> column(column_size);
+    for (std::size_t i = 0; i < column.size(); i++)
+        column[i] = static_cast<T>(i % 100);
+    auto other = column;
+    other.back() = static_cast<T>(101);
+    const T *first = column.data();
+    const T *last = first + column.size();
+    mystd::span<const T> c(first, column.size());
+    mystd::span<const T> o(other.data(), other.size());
+    const auto absent = static_cast<T>(100);
+
+    // passes the result through do_not_optimize
+    auto repeat = [](auto f) {
+        return [f](std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                auto result = f();
+                bench::do_not_optimize(result);
+            }
+        };
+    };
+
+    s.run("find/" + type + "/std",
+          repeat([&] { return std::find(first, last, absent); }));
+    each_level(s, "find/" + type,
+               repeat([&] { return mystd::find(c, absent); }));
+
+    s.run("count/" + type + "/std",
+          repeat([&] { return std::count(first, last, T{7}); }));
+    each_level(s, "count/" + type,
+               repeat([&] { return mystd::count(c, T{7}); }));
+
+    s.run("min/" + type + "/std",
+          repeat([&] { return *std::min_element(first, last); }));
+    each_level(s, "min/" + type, repeat([&] { return mystd::min(c); }));
+
+    s.run("max/" + type + "/std",
+          repeat([&] { return *std::max_element(first, last); }));
+    each_level(s, "max/" + type, repeat([&] { return mystd::max(c); }));
+
+    s.run("sum/" + type + "/std",
+          repeat([&] { return std::accumulate(first, last, T{}); }));
+    each_level(s, "sum/" + type, repeat([&] { return mystd::sum(c); }));
+
+    s.run("mismatch/" + type + "/std", repeat([&] {
+              return std::mismatch(first, last, other.data()).first;
+          }));
+    each_level(s, "mismatch/" + type,
+               repeat([&] { return mystd::mismatch(c, o); }));
+
+    s.run("equal/" + type + "/std", repeat([&] {
+              return std::equal(first, last, other.data());
+          }));
+    each_level(s, "equal/" + type,
+               repeat([&] { return mystd::equal(c, o); }));
+}
+
+auto search_benchmarks(bench::suite &s) -> void {
+    std::string text;
+    while (text.size() < column_size)
+        text += "the quick brown fox jumps over the lazy dog ";
+    text.resize(column_size);
+    std::string_view haystack = text;
+    std::string_view needle = "the lazy cat";
+    mystd::span<const char> h(haystack.data(), haystack.size());
+    mystd::span<const char> n(needle.data(), needle.size());
+
+    s.run("search/char/std", [&](std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            auto it = std::search(haystack.begin(), haystack.end(),
+                                  needle.begin(), needle.end());
+            bench::do_not_optimize(it);
+        }
+    });
+    s.run("search/char/std::string_view::find", [&](std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            auto pos = haystack.find(needle);
+            bench::do_not_optimize(pos);
+        }
+    });
+    each_level(s, "search/char", [&](std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            auto pos = mystd::search(h, n);
+            bench::do_not_optimize(pos);
+        }
+    });
+}
+
+auto main(int argc, char **argv) -> int {
+    bench::suite s("span_algorithms", argc, argv);
+
+    column_benchmarks<std::int8_t>(s, "int8");
+    column_benchmarks<std::int32_t>(s, "int32");
+    column_benchmarks<float>(s, "float");
+    column_benchmarks<double>(s, "double");
+    search_benchmarks(s);
+}
@@ -0,0 +1,217 @@
+#include "bench.hpp"
+#include "memory.hpp"
+#include "vector.hpp"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// one operation builds or copies a whole vector of `count` elements, the
+// difference between `push_back` and `push_back_reserved` is the cost of grow
+
+constexpr std::size_t count = 1024;
+constexpr std::size_t small_count = 8;
+
+// move may throw, so grow has to copy to keep the strong guarantee
+struct throwing_move {
+    std::string value;
+    throwing_move(std::string s) : value(std::move(s)) {}
+    throwing_move(const throwing_move &) = default;
+    throwing_move(throwing_move &&other) noexcept(false)
+        : value(std::move(other.value)) {}
+};
+
+auto make_int(std::size_t i) -> int { return static_cast<int>(i); }
+
+auto make_string(std::size_t i) -> std::string {
+    return std::string(8, static_cast<char>('a' + i % 26));
+}
+
+auto make_throwing_move(std::size_t i) -> throwing_move {
+    return throwing_move(make_string(i));
+}
+
+auto make_mystd_unique(std::size_t i) -> mystd::unique_ptr<int> {
+    return mystd::make_unique<int>(static_cast<int>(i));
+}
+
+auto make_std_unique(std::size_t i) -> std::unique_ptr<int> {
+    return std::make_unique<int>(static_cast<int>(i));
+}
+
+template <class Vec, class Make>
+auto push_back(bench::suite &s, const std::string &name, std::size_t size,
+               Make make) -> void {
+    s.run("push_back/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Vec vec;
+            for (std::size_t j = 0; j < size; j++)
+                vec.emplace_back(make(j));
+            bench::do_not_optimize(vec);
+        }
+    });
+}
+
+template <class Vec, class Make>
+auto push_back_reserved(bench::suite &s, const std::string &name, Make make)
+    -> void {
+    s.run("push_back_reserved/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Vec vec;
+            vec.reserve(count);
+            for (std::size_t j = 0; j < count; j++)
+                vec.emplace_back(make(j));
+            bench::do_not_optimize(vec);
+        }
+    });
+}
+
+// one operation fills a block of `count` elements and grows it once to twice
+// the size, against the same with the plain move loop grow used before it
+// went through `uninitialized_move_if_noexcept` and the allocator
+template <class T, class Make>
+auto grow(bench::suite &s, const std::string &name, Make make) -> void {
+    s.run("grow/" + name + "/mystd::vector", [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            mystd::vector<T> vec;
+            vec.reserve(count);
+            for (std::size_t j = 0; j < count; j++)
+                vec.emplace_back(make(j));
+            vec.reserve(2 * count);
+            bench::do_not_optimize(vec);
+        }
+    });
+    s.run("grow/" + name + "/move_loop", [&](std::size_t n) {
+        std::allocator<T> alloc;
+        for (std::size_t i = 0; i < n; i++) {
+            T *data = alloc.allocate(count);
+            for (std::size_t j = 0; j < count; j++)
+                std::construct_at(data + j, make(j));
+
+            T *new_data = alloc.allocate(2 * count);
+            for (std::size_t j = 0; j < count; j++)
+                std::construct_at(new_data + j, std::move(data[j]));
+            std::destroy(data, data + count);
+            alloc.deallocate(data, count);
+            bench::do_not_optimize(new_data);
+
+            std::destroy(new_data, new_data + count);
+            alloc.deallocate(new_data, 2 * count);
+        }
+    });
+}
+
+template <class Vec, class Make>
+auto copy_and_move(bench::suite &s, const std::string &name, std::size_t size,
+                   Make make) -> void {
+    Vec source;
+    for (std::size_t j = 0; j < size; j++)
+        source.emplace_back(make(j));
+
+    s.run("copy/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Vec copy(source);
+            bench::do_not_optimize(copy);
+        }
+    });
+    // moves the source away and back
+    s.run("move/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Vec tmp(std::move(source));
+            bench::do_not_optimize(tmp);
+            source = std::move(tmp);
+        }
+    });
+}
+
+template <class Vec, class Make>
+auto swap(bench::suite &s, const std::string &name, std::size_t size,
+          Make make) -> void {
+    Vec a;
+    Vec b;
+    for (std::size_t j = 0; j < size; j++) {
+        a.emplace_back(make(j));
+        b.emplace_back(make(j + 1));
+    }
+    s.run("swap/" + name, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            using std::swap;
+            swap(a, b);
+            bench::do_not_optimize(a);
+        }
+    });
+}
+
+auto main(int argc, char **argv) -> int {
+    bench::suite s("vector", argc, argv);
+
+    // growth, elements are trivially copyable, nothrow-movable, trivially
+    // relocatable only in mystd, and copied on grow
+    push_back<mystd::vector<int>>(s, "int/mystd::vector", count, make_int);
+    push_back<std::vector<int>>(s, "int/std::vector", count, make_int);
+    push_back<mystd::vector<std::string>>(s, "string/mystd::vector", count,
+                                          make_string);
+    push_back<std::vector<std::string>>(s, "string/std::vector", count,
+                                        make_string);
+    push_back<mystd::vector<mystd::unique_ptr<int>>>(
+        s, "unique_ptr/mystd::vector", count, make_mystd_unique);
+    push_back<std::vector<std::unique_ptr<int>>>(s, "unique_ptr/std::vector",
+                                                 count, make_std_unique);
+    push_back<mystd::vector<throwing_move>>(s, "throwing_move/mystd::vector",
+                                            count, make_throwing_move);
+    push_back<std::vector<throwing_move>>(s, "throwing_move/std::vector",
+                                          count, make_throwing_move);
+
+    push_back_reserved<mystd::vector<int>>(s, "int/mystd::vector", make_int);
+    push_back_reserved<std::vector<int>>(s, "int/std::vector", make_int);
+    push_back_reserved<mystd::vector<std::string>>(s, "string/mystd::vector",
+                                                   make_string);
+    push_back_reserved<std::vector<std::string>>(s, "string/std::vector",
+                                                 make_string);
+
+    // grow of nothrow-movable elements that are not trivially relocatable
+    // should cost no more than a plain move loop
+    grow<std::string>(s, "string", make_string);
+
+    // fixed_capacity_vector never grows, compare with a reserved std::vector
+    push_back<mystd::fixed_capacity_vector<int, count>>(
+        s, "int/mystd::fixed_capacity_vector", count, make_int);
+
+    // small vectors that stay in the inline buffer
+    push_back<mystd::small_size_optimized_vector<int, 16>>(
+        s, "int/8/mystd::small_size_optimized_vector", small_count, make_int);
+    push_back<mystd::fixed_capacity_vector<int, 16>>(
+        s, "int/8/mystd::fixed_capacity_vector", small_count, make_int);
+    push_back<mystd::vector<int>>(s, "int/8/mystd::vector", small_count,
+                                  make_int);
+    push_back<std::vector<int>>(s, "int/8/std::vector", small_count, make_int);
+
+    // copy and move
+    copy_and_move<mystd::vector<int>>(s, "int/mystd::vector", count, make_int);
+    copy_and_move<std::vector<int>>(s, "int/std::vector", count, make_int);
+    copy_and_move<mystd::vector<std::string>>(s, "string/mystd::vector",
+                                              count, make_string);
+    copy_and_move<std::vector<std::string>>(s, "string/std::vector", count,
+                                            make_string);
+    copy_and_move<mystd::fixed_capacity_vector<int, count>>(
+        s, "int/mystd::fixed_capacity_vector", count, make_int);
+    copy_and_move<mystd::small_size_optimized_vector<int, 16>>(
+        s, "int/8/mystd::small_size_optimized_vector", small_count, make_int);
+    copy_and_move<mystd::small_size_optimized_vector<std::string, 16>>(
+        s, "string/8/mystd::small_size_optimized_vector", small_count,
+        make_string);
+    copy_and_move<std::vector<std::string>>(s, "string/8/std::vector",
+                                            small_count, make_string);
+
+    // swap, inline buffers and heap storage
+    swap<mystd::small_size_optimized_vector<int, 16>>(
+        s, "int/8/mystd::small_size_optimized_vector", small_count, make_int);
+    swap<mystd::small_size_optimized_vector<std::string, 16>>(
+        s, "string/8/mystd::small_size_optimized_vector", small_count,
+        make_string);
+    swap<mystd::small_size_optimized_vector<std::string, 4>>(
+        s, "string/8/heap/mystd::small_size_optimized_vector", small_count,
+        make_string);
+    swap<std::vector<std::string>>(s, "string/8/std::vector", small_count,
+                                   make_string);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "resource_allocator.hpp"
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace mystd {
+
+// ****************************************************************************
+// *                             fixed_size_pool                              *
+// ****************************************************************************
+
+// hands out blocks of one fixed size from a free list
+//  - allocation and deallocation are a pop/push of a singly linked list
+//  - blocks are carved from chunks of `blocks_per_chunk` blocks, chunks are
+//    only given back by `release()` or the destructor
+//  - requests larger than the block size (or over-aligned) fall through to
+//    `::operator new`, e.g. when a vector outgrows its usual capacity
+//  - not thread-safe
+class fixed_size_pool {
+  public:
+    // constructors
+    explicit fixed_size_pool(std::size_t block_size,
+                             std::size_t blocks_per_chunk = 64) noexcept
+        : _block_size{round_up(block_size)},
+          _blocks_per_chunk{blocks_per_chunk > 0 ? blocks_per_chunk : 1} {}
+
+    fixed_size_pool(const fixed_size_pool &) = delete;
+    auto operator=(const fixed_size_pool &) -> fixed_size_pool & = delete;
+
+    // destructor
+    ~fixed_size_pool() { release(); }
+
+    // allocation
+    [[nodiscard]] auto allocate(std::size_t bytes, std::size_t alignment)
+        -> void * {
+        if (!fits(bytes, alignment))
+            return ::operator new(bytes, std::align_val_t{alignment});
+        if (_free == nullptr)
+            new_chunk();
+        return std::exchange(_free, _free->next);
+    }
+
+    auto deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept
+        -> void {
+        if (!fits(bytes, alignment)) {
+            ::operator delete(p, bytes, std::align_val_t{alignment});
+            return;
+        }
+        _free = ::new (p) free_block{_free};
+    }
+
+    // give every chunk back, all blocks from the pool become invalid
+    auto release() noexcept -> void {
+        while (_chunks != nullptr) {
+            auto next = _chunks->next;
+            ::operator delete(_chunks, chunk_bytes());
+            _chunks = next;
+        }
+        _free = nullptr;
+    }
+
+    // observers
+    auto block_size() const noexcept -> std::size_t { return _block_size; }
+
+  private:
+    struct free_block {
+        free_block *next;
+    };
+
+    // header is padded so that the blocks following it stay max-aligned
+    struct alignas(std::max_align_t) chunk_header {
+        chunk_header *next;
+    };
+
+    std::size_t _block_size;
+    std::size_t _blocks_per_chunk;
+    free_block *_free = nullptr;
+    chunk_header *_chunks = nullptr;
+
+    static constexpr auto round_up(std::size_t n) noexcept -> std::size_t {
+        constexpr auto align = alignof(std::max_align_t);
+        n = n > sizeof(free_block) ? n : sizeof(free_block);
+        return (n + align - 1) / align * align;
+    }
+
+    auto fits(std::size_t bytes, std::size_t alignment) const noexcept
+        -> bool {
+        return bytes <= _block_size && alignment <= alignof(std::max_align_t);
+    }
+
+    auto chunk_bytes() const noexcept -> std::size_t {
+        return sizeof(chunk_header) + _block_size * _blocks_per_chunk;
+    }
+
+    auto new_chunk() -> void {
+        auto chunk =
+            ::new (::operator new(chunk_bytes())) chunk_header{_chunks};
+        _chunks = chunk;
+        // thread the blocks of the new chunk onto the free list
+        auto first = reinterpret_cast<std::byte *>(chunk + 1);
+        for (auto i = _blocks_per_chunk; i-- > 0;)
+            _free = ::new (first + i * _block_size) free_block{_free};
+    }
+};
+
+template <class T>
+using pool_allocator = resource_allocator<T, fixed_size_pool>;
+
+} // namespace mystd
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace mystd {
+
+// ****************************************************************************
+// *                             malloc_allocator                             *
+// ****************************************************************************
+
+// a stateless allocator over `malloc`/`free` that can also resize a block
+//  - `reallocate(p, old_n, new_n)` is the extension `vector::grow` looks for,
+//    it may extend the block in place instead of allocate + copy + free
+//      - blocks below `mmap_threshold` bytes use `realloc`
+//      - larger blocks (Linux only) are mapped with `mmap` and resized with
+//        `mremap`, which moves page table entries instead of copying bytes
+//  - the bytes are moved as is, only valid for trivially relocatable `T`
+template <class T> class malloc_allocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "over-aligned types are not supported");
+
+  public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+#if defined(__linux__)
+    static constexpr std::size_t mmap_threshold = std::size_t{1} << 20;
+#else
+    static constexpr std::size_t mmap_threshold = static_cast<std::size_t>(-1);
+#endif
+
+    // constructors
+    constexpr malloc_allocator() noexcept = default;
+    template <class U>
+    constexpr malloc_allocator(const malloc_allocator<U> &) noexcept {}
+
+    // allocation
+    [[nodiscard]] auto allocate(std::size_t n) -> T * {
+        return static_cast<T *>(do_allocate(bytes_of(n)));
+    }
+
+    auto deallocate(T *p, std::size_t n) noexcept -> void {
+        auto bytes = n * sizeof(T);
+#if defined(__linux__)
+        if (bytes >= mmap_threshold) {
+            ::munmap(p, page_round(bytes));
+            return;
+        }
+#endif
+        std::free(p);
+    }
+
+    // resize the block of old_n elements at p to new_n elements, keeping the
+    // bytes of the first min(old_n, new_n) elements
+    // throws std::bad_alloc on failure, in which case p is left untouched
+    [[nodiscard]] auto reallocate(T *p, std::size_t old_n, std::size_t new_n)
+        -> T * {
+        auto old_bytes = old_n * sizeof(T);
+        auto new_bytes = bytes_of(new_n);
+        void *res = nullptr;
+        if (old_bytes < mmap_threshold && new_bytes < mmap_threshold) {
+            res = std::realloc(static_cast<void *>(p), new_bytes);
+        }
+#if defined(__linux__)
+        else if (old_bytes >= mmap_threshold && new_bytes >= mmap_threshold) {
+            res = ::mremap(p, page_round(old_bytes), page_round(new_bytes),
+                           MREMAP_MAYMOVE);
+            if (res == MAP_FAILED)
+                res = nullptr;
+        }
+#endif
+        else {
+            // crossing the threshold, switch between malloc and mmap
+            res = do_allocate(new_bytes);
+            std::memcpy(res, static_cast<void *>(p),
+                        old_bytes < new_bytes ? old_bytes : new_bytes);
+            deallocate(p, old_n);
+        }
+        if (res == nullptr)
+            throw std::bad_alloc{};
+        return static_cast<T *>(res);
+    }
+
+    // compare
+    template <class U>
+    constexpr auto operator==(const malloc_allocator<U> &) const noexcept
+        -> bool {
+        return true;
+    }
+
+  private:
+    static auto bytes_of(std::size_t n) -> std::size_t {
+        if (n > static_cast<std::size_t>(-1) / sizeof(T))
+            throw std::bad_array_new_length{};
+        return n * sizeof(T);
+    }
+
+    static auto do_allocate(std::size_t bytes) -> void * {
+        void *p = nullptr;
+#if defined(__linux__)
+        if (bytes >= mmap_threshold) {
+            p = ::mmap(nullptr, page_round(bytes), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED)
+                throw std::bad_alloc{};
+            return p;
+        }
+#endif
+        p = std::malloc(bytes > 0 ? bytes : 1);
+        if (p == nullptr)
+            throw std::bad_alloc{};
+        return p;
+    }
+
+#if defined(__linux__)
+    static auto page_round(std::size_t bytes) noexcept -> std::size_t {
+        static const auto page =
+            static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return (bytes + page - 1) / page * page;
+    }
+#endif
+};
+
+} // namespace mystd
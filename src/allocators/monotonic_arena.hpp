@@ -0,0 +1,112 @@
+#pragma once
+
+#include "resource_allocator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace mystd {
+
+// ****************************************************************************
+// *                             monotonic_arena                              *
+// ****************************************************************************
+
+// allocates by bumping a pointer, memory is only given back all at once by
+// `release()` or the destructor
+//  - starts from an optional user-provided buffer (e.g. on the stack), then
+//    takes geometrically growing chunks from `::operator new`
+//  - `deallocate` only reclaims the most recent allocation, so a vector that
+//    grows alone in the arena does not leave every old buffer behind
+//  - not thread-safe, meant to be owned by one request/thread
+class monotonic_arena {
+  public:
+    // constructors
+    explicit monotonic_arena(std::size_t initial_size = 4096) noexcept
+        : _next_size{initial_size > 0 ? initial_size : 1} {}
+
+    monotonic_arena(void *buffer, std::size_t size) noexcept
+        : _cur{static_cast<std::byte *>(buffer)}, _end{_cur + size},
+          _buffer{_cur}, _buffer_size{size},
+          _next_size{size > 0 ? size * 2 : 4096} {}
+
+    monotonic_arena(const monotonic_arena &) = delete;
+    auto operator=(const monotonic_arena &) -> monotonic_arena & = delete;
+
+    // destructor
+    ~monotonic_arena() { release(); }
+
+    // allocation
+    [[nodiscard]] auto allocate(std::size_t bytes, std::size_t alignment)
+        -> void * {
+        // the padding may not fit either, nothing is computed past _end
+        auto padding = padding_for(_cur, alignment);
+        auto space = static_cast<std::size_t>(_end - _cur);
+        if (_cur == nullptr || padding > space || bytes > space - padding) {
+            new_chunk(bytes + alignment);
+            padding = padding_for(_cur, alignment);
+        }
+        auto p = _cur + padding;
+        _last = p;
+        _cur = p + bytes;
+        return p;
+    }
+
+    auto deallocate(void *p, std::size_t bytes, std::size_t) noexcept
+        -> void {
+        // roll back if it is the most recent allocation
+        if (p == _last && _last + bytes == _cur) {
+            _cur = _last;
+            _last = nullptr;
+        }
+    }
+
+    // give every chunk back and restart from the initial buffer
+    auto release() noexcept -> void {
+        while (_chunks != nullptr) {
+            auto next = _chunks->next;
+            ::operator delete(_chunks, _chunks->size);
+            _chunks = next;
+        }
+        _cur = _buffer;
+        _end = _buffer + _buffer_size;
+        _last = nullptr;
+    }
+
+  private:
+    struct chunk_header {
+        chunk_header *next;
+        std::size_t size;
+    };
+
+    std::byte *_cur = nullptr;
+    std::byte *_end = nullptr;
+    std::byte *_last = nullptr;
+    std::byte *_buffer = nullptr;
+    std::size_t _buffer_size = 0;
+    std::size_t _next_size;
+    chunk_header *_chunks = nullptr;
+
+    // the number of bytes from p to the next address aligned to alignment
+    static auto padding_for(const std::byte *p, std::size_t alignment) noexcept
+        -> std::size_t {
+        auto addr = reinterpret_cast<std::uintptr_t>(p);
+        return ((addr + alignment - 1) & ~(alignment - 1)) - addr;
+    }
+
+    auto new_chunk(std::size_t min_bytes) -> void {
+        while (_next_size < min_bytes)
+            _next_size *= 2;
+        auto size = sizeof(chunk_header) + _next_size;
+        auto chunk = ::new (::operator new(size)) chunk_header{_chunks, size};
+        _chunks = chunk;
+        _cur = reinterpret_cast<std::byte *>(chunk + 1);
+        _end = reinterpret_cast<std::byte *>(chunk) + size;
+        _next_size *= 2;
+    }
+};
+
+template <class T>
+using arena_allocator = resource_allocator<T, monotonic_arena>;
+
+} // namespace mystd
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace mystd {
+
+namespace detail {
+
+template <class R>
+concept memory_resource = requires(R r, void *p, std::size_t n) {
+    { r.allocate(n, n) } -> std::same_as<void *>;
+    r.deallocate(p, n, n);
+};
+
+} // namespace detail
+
+// ****************************************************************************
+// *                            resource_allocator                            *
+// ****************************************************************************
+
+// a standard allocator that forwards to a memory resource it does not own,
+// such as `monotonic_arena` or `fixed_size_pool`
+//  - 8 bytes: a pointer to the resource
+//  - never propagates, containers keep the resource they are constructed with
+template <class T, detail::memory_resource Resource> class resource_allocator {
+  public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    using is_always_equal = std::false_type;
+
+    // constructors
+    resource_allocator(Resource &resource) noexcept : _resource{&resource} {}
+
+    template <class U>
+    resource_allocator(const resource_allocator<U, Resource> &other) noexcept
+        : _resource{other.resource()} {}
+
+    // allocation
+    [[nodiscard]] auto allocate(std::size_t n) -> T * {
+        if (n > static_cast<std::size_t>(-1) / sizeof(T))
+            throw std::bad_array_new_length{};
+        return static_cast<T *>(_resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    auto deallocate(T *p, std::size_t n) noexcept -> void {
+        _resource->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    // observers
+    auto resource() const noexcept -> Resource * { return _resource; }
+
+    // compare
+    template <class U>
+    auto operator==(const resource_allocator<U, Resource> &rhs) const noexcept
+        -> bool {
+        return _resource == rhs.resource();
+    }
+
+  private:
+    Resource *_resource;
+};
+
+} // namespace mystd
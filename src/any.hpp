@@ -1,41 +1,105 @@
 #pragma once
 
-#include "memory.hpp"
-#include <array>
 #include <concepts>
+#include <cstddef>
 #include <initializer_list>
+#include <new>
 #include <type_traits>
 #include <typeinfo>
 #include <utility>
 
+// `any::type()` needs RTTI, everything else works with -fno-rtti
+#if defined(__cpp_rtti) || defined(__GXX_RTTI)
+#define MYSTD_ANY_HAS_RTTI 1
+#else
+#define MYSTD_ANY_HAS_RTTI 0
+#endif
+
 namespace mystd {
 
 class any;
 
 namespace detail {
 
-struct AnyBase {
-    virtual ~AnyBase() = default;
-    virtual auto clone() const -> unique_ptr<AnyBase> = 0;
-    virtual auto type() const noexcept -> const std::type_info & = 0;
+// a value is stored in the buffer if it fits and is nothrow move
+// constructible, so that moving an any never throws
+inline constexpr std::size_t any_buffer_size = 3 * sizeof(void *);
+
+union AnyStorage {
+    void *heap;
+    alignas(void *) std::byte buffer[any_buffer_size];
+};
+
+template <class T>
+concept any_fits_inline = sizeof(T) <= any_buffer_size &&
+                          alignof(T) <= alignof(void *) &&
+                          std::is_nothrow_move_constructible_v<T>;
+
+// one table of functions per stored type, its address identifies the type
+struct AnyVTable {
+    // copies the value of src into dst, which holds nothing
+    void (*copy)(const AnyStorage &src, AnyStorage &dst);
+    // moves the value of src into dst, which holds nothing, src is left
+    // holding nothing
+    void (*move)(AnyStorage &src, AnyStorage &dst) noexcept;
+    void (*destroy)(AnyStorage &storage) noexcept;
+#if MYSTD_ANY_HAS_RTTI
+    const std::type_info *type;
+#endif
 };
 
-template <class T> struct AnyDerive : AnyBase {
-    T value_;
+template <class T> struct AnyManager {
+    static constexpr bool is_inline = any_fits_inline<T>;
+
+    static auto get(AnyStorage &storage) noexcept -> T * {
+        if constexpr (is_inline)
+            return static_cast<T *>(static_cast<void *>(storage.buffer));
+        else
+            return static_cast<T *>(storage.heap);
+    }
 
-    explicit AnyDerive(const T &t) : value_(t) {}
-    explicit AnyDerive(T &&t) : value_(std::move(t)) {}
+    static auto get(const AnyStorage &storage) noexcept -> const T * {
+        return get(const_cast<AnyStorage &>(storage));
+    }
 
     template <class... Args>
-    explicit AnyDerive(Args &&...args) : value_(std::forward<Args>(args)...) {}
+    static auto create(AnyStorage &storage, Args &&...args) -> T & {
+        if constexpr (is_inline) {
+            return *::new (static_cast<void *>(storage.buffer))
+                T(std::forward<Args>(args)...);
+        } else {
+            auto p = new T(std::forward<Args>(args)...);
+            storage.heap = p;
+            return *p;
+        }
+    }
 
-    auto clone() const -> unique_ptr<AnyBase> override {
-        return make_unique<AnyDerive<T>>(value_);
+    static auto copy(const AnyStorage &src, AnyStorage &dst) -> void {
+        create(dst, *get(src));
     }
 
-    auto type() const noexcept -> const std::type_info & override {
-        return typeid(T);
+    static auto move(AnyStorage &src, AnyStorage &dst) noexcept -> void {
+        if constexpr (is_inline) {
+            create(dst, std::move(*get(src)));
+            get(src)->~T();
+        } else {
+            // a heap value is moved by its pointer
+            dst.heap = src.heap;
+        }
     }
+
+    static auto destroy(AnyStorage &storage) noexcept -> void {
+        if constexpr (is_inline)
+            get(storage)->~T();
+        else
+            delete get(storage);
+    }
+
+#if MYSTD_ANY_HAS_RTTI
+    static constexpr AnyVTable vtable{&copy, &move, &destroy, &typeid(T)};
+#else
+    static constexpr AnyVTable vtable{&copy, &move, &destroy};
+#endif
 };
 
 template <class T>
@@ -57,19 +121,32 @@ class bad_any_cast : public std::bad_cast {
     }
 };
 
+// small nothrow movable values, e.g. `int`, `double` or `std::vector`, are
+// stored in a buffer inside the any, larger ones on the heap
+//  - the buffer holds 3 pointers, `std::string` is 4 in libstdc++ and goes
+//    on the heap
+//  - the stored type is known through a pointer to its static AnyVTable, so
+//    `any_cast` compares two pointers
 class any {
   public:
     // constructors
-    constexpr any() noexcept : ptr_(nullptr) {}
+    constexpr any() noexcept {}
 
     template <class T>
         requires detail::any_constructible<T>
-    any(T &&value)
-        : ptr_{make_unique<detail::AnyDerive<std::decay_t<T>>>(
-              std::forward<T>(value))} {}
+    any(T &&value) {
+        using manager = detail::AnyManager<std::decay_t<T>>;
+        manager::create(storage_, std::forward<T>(value));
+        vtable_ = &manager::vtable;
+    }
 
-    any(const any &other) : ptr_(other.ptr_ ? other.ptr_->clone() : nullptr) {}
-    any(any &&) noexcept = default;
+    any(const any &other) {
+        if (other.vtable_ != nullptr) {
+            other.vtable_->copy(other.storage_, storage_);
+            vtable_ = other.vtable_;
+        }
+    }
+    any(any &&other) noexcept { take(other); }
 
     template <class T, class... Args>
         requires detail::any_constructible_from<T, Args...>
@@ -86,16 +163,22 @@ class any {
     }
 
     // destructor
-    ~any() = default;
+    ~any() { reset(); }
 
     // assignment operators
     auto operator=(const any &rhs) -> any & {
         if (this == &rhs)
             return *this;
-        ptr_ = rhs.ptr_ ? rhs.ptr_->clone() : nullptr;
+        any(rhs).swap(*this);
+        return *this;
+    }
+    auto operator=(any &&rhs) noexcept -> any & {
+        if (this == &rhs)
+            return *this;
+        reset();
+        take(rhs);
         return *this;
     }
-    auto operator=(any &&) noexcept -> any & = default;
 
     template <class T> auto operator=(T &&value) -> any & {
         return *this = any(std::forward<T>(value));
@@ -105,10 +188,11 @@ class any {
     template <class T, class... Args>
         requires detail::any_constructible_from<T, Args...>
     auto emplace(Args &&...args) -> std::decay_t<T> & {
-        ptr_ = make_unique<detail::AnyDerive<std::decay_t<T>>>(
-            std::forward<Args>(args)...);
-        return static_cast<detail::AnyDerive<std::decay_t<T>> *>(ptr_.get())
-            ->value_;
+        using manager = detail::AnyManager<std::decay_t<T>>;
+        reset();
+        auto &value = manager::create(storage_, std::forward<Args>(args)...);
+        vtable_ = &manager::vtable;
+        return value;
     }
 
     template <class T, class U, class... Args>
@@ -116,75 +200,93 @@ class any {
                                                 Args...>
     auto emplace(std::initializer_list<U> il, Args &&...args)
         -> std::decay_t<T> & {
-        ptr_ = make_unique<detail::AnyDerive<std::decay_t<T>>>(
-            il, std::forward<Args>(args)...);
-        return static_cast<detail::AnyDerive<std::decay_t<T>> *>(ptr_.get())
-            ->value_;
+        using manager = detail::AnyManager<std::decay_t<T>>;
+        reset();
+        auto &value =
+            manager::create(storage_, il, std::forward<Args>(args)...);
+        vtable_ = &manager::vtable;
+        return value;
     }
 
-    auto reset() noexcept -> void { ptr_.reset(); }
+    auto reset() noexcept -> void {
+        if (vtable_ != nullptr) {
+            vtable_->destroy(storage_);
+            vtable_ = nullptr;
+        }
+    }
 
-    auto swap(any &other) noexcept -> void { ptr_.swap(other.ptr_); }
+    auto swap(any &other) noexcept -> void {
+        if (this == &other)
+            return;
+        any tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
 
     // observers
-    auto has_value() const noexcept -> bool { return static_cast<bool>(ptr_); }
+    auto has_value() const noexcept -> bool { return vtable_ != nullptr; }
 
+#if MYSTD_ANY_HAS_RTTI
     auto type() const noexcept -> const std::type_info & {
-        return has_value() ? ptr_->type() : typeid(void);
+        return has_value() ? *vtable_->type : typeid(void);
     }
+#endif
 
   private:
-    unique_ptr<detail::AnyBase> ptr_;
+    const detail::AnyVTable *vtable_ = nullptr;
+    detail::AnyStorage storage_;
+
+    // moves the value out of other, which is left empty
+    auto take(any &other) noexcept -> void {
+        if (other.vtable_ != nullptr) {
+            other.vtable_->move(other.storage_, storage_);
+            vtable_ = std::exchange(other.vtable_, nullptr);
+        }
+    }
+
+    // cv-qualifiers are ignored, as typeid does
+    template <class T> auto holds() const noexcept -> bool {
+        return vtable_ == &detail::AnyManager<std::remove_cv_t<T>>::vtable;
+    }
 
     template <class T>
     friend auto any_cast(const any *a) noexcept -> const T * {
-        if (a == nullptr)
+        if (a == nullptr || !a->holds<T>())
             return nullptr;
-        if (a->type() == typeid(T))
-            return &static_cast<detail::AnyDerive<std::remove_const_t<T>> *>(
-                        a->ptr_.get())
-                        ->value_;
-        return nullptr;
+        return detail::AnyManager<std::remove_cv_t<T>>::get(a->storage_);
     }
 
     template <class T> friend auto any_cast(any *a) noexcept -> T * {
-        if (a == nullptr)
+        if (a == nullptr || !a->holds<T>())
             return nullptr;
-        if (a->type() == typeid(T))
-            return &static_cast<detail::AnyDerive<std::remove_const_t<T>> *>(
-                        a->ptr_.get())
-                        ->value_;
-        return nullptr;
+        return detail::AnyManager<std::remove_cv_t<T>>::get(a->storage_);
     }
 
     template <class T, class DecayT = std::decay_t<T>>
         requires std::constructible_from<T, const DecayT &>
     friend auto any_cast(const any &a) -> T {
-        if (typeid(DecayT) == a.type())
-            return static_cast<detail::AnyDerive<DecayT> *>(a.ptr_.get())
-                ->value_;
+        if (a.holds<DecayT>())
+            return *detail::AnyManager<DecayT>::get(a.storage_);
         throw bad_any_cast{};
     }
 
     template <class T, class DecayT = std::decay_t<T>>
         requires std::constructible_from<T, DecayT &>
     friend auto any_cast(any &a) -> T {
-        if (typeid(DecayT) == a.type())
-            return static_cast<detail::AnyDerive<DecayT> *>(a.ptr_.get())
-                ->value_;
+        if (a.holds<DecayT>())
+            return *detail::AnyManager<DecayT>::get(a.storage_);
         throw bad_any_cast{};
     }
 
     template <class T, class DecayT = std::decay_t<T>>
         requires std::constructible_from<T, DecayT &&>
     friend auto any_cast(any &&a) -> T {
-        if (typeid(DecayT) == a.type())
-            return static_cast<detail::AnyDerive<DecayT> *>(a.ptr_.get())
-                ->value_;
+        if (a.holds<DecayT>())
+            return std::move(*detail::AnyManager<DecayT>::get(a.storage_));
         throw bad_any_cast{};
     }
 };
 
 auto swap(any &lhs, any &rhs) noexcept -> void { lhs.swap(rhs); }
 
-} // namespace mystd
\ No newline at end of file
+} // namespace mystd
@@ -1,7 +1,12 @@
 #pragma once
 
+#include "relocate.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace mystd {
 
@@ -10,7 +15,15 @@ namespace detail {
 template <class T>
 concept sufficiently_trivial =
     std::is_trivially_destructible_v<T> && std::is_trivially_constructible_v<T>;
-}
+
+// the smallest unsigned integer type that can hold N
+template <std::size_t N>
+using compact_size_t = std::conditional_t<
+    N <= UINT8_MAX, std::uint8_t,
+    std::conditional_t<
+        N <= UINT16_MAX, std::uint16_t,
+        std::conditional_t<N <= UINT32_MAX, std::uint32_t, std::size_t>>>;
+} // namespace detail
 
 template <class T, std::size_t N> class fixed_capacity_vector {
   public:
@@ -20,43 +33,48 @@ template <class T, std::size_t N> class fixed_capacity_vector {
     using const_reference = const value_type &;
     using iterator = T *;
     using const_iterator = const T *;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // elements are stored inline, so relocatable iff its elements are
+    using trivially_relocatable =
+        std::bool_constant<is_trivially_relocatable_v<T>>;
 
     // constructors
     constexpr fixed_capacity_vector() noexcept : _sz{0} {}
+
+    // delegates to the default constructor, so the destructor cleans up if an
+    // element copy throws
     constexpr fixed_capacity_vector(const fixed_capacity_vector &other)
-        : _sz{other._sz} {
-        for (size_type i = 0; i < _sz; i++)
-            std::construct_at(begin() + i, other[i]);
+        : fixed_capacity_vector() {
+        copy_from(other);
     }
 
-    constexpr fixed_capacity_vector(fixed_capacity_vector &&other) noexcept
-        : _sz{other._sz} {
-        for (size_type i = 0; i < _sz; i++)
-            std::construct_at(begin() + i, std::move(other[i]));
-        other._sz = 0;
+    // elements are relocated: other is left empty
+    //  - delegates to the default constructor, so the destructor cleans up if
+    //    an element move throws
+    constexpr fixed_capacity_vector(fixed_capacity_vector &&other) noexcept(
+        std::is_nothrow_move_constructible_v<T>)
+        : fixed_capacity_vector() {
+        move_from(other);
     }
 
     // assignments
     constexpr auto operator=(const fixed_capacity_vector &other)
         -> fixed_capacity_vector & {
-        if constexpr (!std::is_trivially_destructible_v<T>) {
-            destroy_all();
-        }
-        _sz = other._sz;
-        for (size_type i = 0; i < _sz; i++)
-            std::construct_at(begin() + i, other[i]);
+        if (this == &other)
+            return *this;
+        clear();
+        copy_from(other);
         return *this;
     }
 
-    constexpr auto operator=(fixed_capacity_vector &&other)
-        -> fixed_capacity_vector & {
-        if constexpr (!std::is_trivially_destructible_v<T>) {
-            destroy_all();
-        }
-        _sz = other._sz;
-        for (size_type i = 0; i < _sz; i++)
-            std::construct_at(begin() + i, std::move(other[i]));
-        other._sz = 0;
+    constexpr auto operator=(fixed_capacity_vector &&other) noexcept(
+        std::is_nothrow_move_constructible_v<T>) -> fixed_capacity_vector & {
+        if (this == &other)
+            return *this;
+        clear();
+        move_from(other);
         return *this;
     }
 
@@ -68,7 +86,8 @@ template <class T, std::size_t N> class fixed_capacity_vector {
     }
 
     // element access
-    constexpr auto data() const noexcept -> T * { return begin(); }
+    constexpr auto data() noexcept -> T * { return begin(); }
+    constexpr auto data() const noexcept -> const T * { return begin(); }
 
     constexpr auto begin() noexcept -> iterator {
         if constexpr (detail::sufficiently_trivial<T>) {
@@ -92,6 +111,27 @@ template <class T, std::size_t N> class fixed_capacity_vector {
         return begin() + _sz;
     }
 
+    constexpr auto cbegin() const noexcept -> const_iterator { return begin(); }
+    constexpr auto cend() const noexcept -> const_iterator { return end(); }
+    constexpr auto rbegin() noexcept -> reverse_iterator {
+        return reverse_iterator(end());
+    }
+    constexpr auto rbegin() const noexcept -> const_reverse_iterator {
+        return const_reverse_iterator(end());
+    }
+    constexpr auto rend() noexcept -> reverse_iterator {
+        return reverse_iterator(begin());
+    }
+    constexpr auto rend() const noexcept -> const_reverse_iterator {
+        return const_reverse_iterator(begin());
+    }
+    constexpr auto crbegin() const noexcept -> const_reverse_iterator {
+        return rbegin();
+    }
+    constexpr auto crend() const noexcept -> const_reverse_iterator {
+        return rend();
+    }
+
     constexpr auto operator[](size_type pos) noexcept -> reference {
         return *(begin() + pos);
     }
@@ -115,7 +155,17 @@ template <class T, std::size_t N> class fixed_capacity_vector {
 
     template <class... Args>
     constexpr auto emplace_back(Args &&...args) -> reference {
-        return *std::construct_at(begin() + _sz++, std::forward<Args>(args)...);
+        auto p = std::construct_at(begin() + _sz, std::forward<Args>(args)...);
+        ++_sz;
+        return *p;
+    }
+
+    // returns nullptr instead of overflowing when full
+    template <class... Args>
+    constexpr auto try_emplace_back(Args &&...args) -> T * {
+        if (_sz == N)
+            return nullptr;
+        return &emplace_back(std::forward<Args>(args)...);
     }
 
     constexpr auto pop_back() noexcept -> void {
@@ -125,13 +175,102 @@ template <class T, std::size_t N> class fixed_capacity_vector {
         }
     }
 
+    template <class... Args>
+    constexpr auto emplace(const_iterator pos, Args &&...args) -> iterator {
+        auto idx = static_cast<size_type>(pos - begin());
+        if (idx == _sz) {
+            emplace_back(std::forward<Args>(args)...);
+            return begin() + idx;
+        }
+        // args may refer to an element of this container, construct it first
+        T value(std::forward<Args>(args)...);
+        detail::insert_one(begin() + idx, begin() + _sz, std::move(value));
+        ++_sz;
+        return begin() + idx;
+    }
+
+    constexpr auto insert(const_iterator pos, const T &value) -> iterator {
+        return emplace(pos, value);
+    }
+
+    constexpr auto insert(const_iterator pos, T &&value) -> iterator {
+        return emplace(pos, std::move(value));
+    }
+
+    constexpr auto erase(const_iterator pos) -> iterator {
+        return erase(pos, pos + 1);
+    }
+
+    constexpr auto erase(const_iterator first, const_iterator last)
+        -> iterator {
+        auto p = begin() + (first - begin());
+        auto new_end =
+            detail::erase_range(p, begin() + (last - begin()), begin() + _sz);
+        _sz = static_cast<compact_size_type>(new_end - begin());
+        return p;
+    }
+
+    // O(1) but does not keep the order: the last element is moved into pos
+    constexpr auto unordered_erase(const_iterator pos) -> iterator {
+        auto p = begin() + (pos - begin());
+        auto new_end = detail::unordered_erase(p, begin() + _sz);
+        _sz = static_cast<compact_size_type>(new_end - begin());
+        return p;
+    }
+
+    template <class Pred>
+    friend constexpr auto erase_if(fixed_capacity_vector &c, Pred pred)
+        -> size_type {
+        return detail::erase_if(c.begin(), c._sz, pred);
+    }
+
+    template <class U>
+    friend constexpr auto erase(fixed_capacity_vector &c, const U &value)
+        -> size_type {
+        return erase_if(c, [&value](const T &elem) { return elem == value; });
+    }
+
   private:
     using storage_type = std::conditional_t<detail::sufficiently_trivial<T>,
                                             T[N], char[N * sizeof(T)]>;
+    // the size never exceeds N, so it is stored in the smallest type that fits
+    // N, e.g. `fixed_capacity_vector<char, 15>` is 16 bytes instead of 24
+    using compact_size_type = detail::compact_size_t<N>;
+
     alignas(T) storage_type _storage;
-    size_type _sz;
+    compact_size_type _sz;
+
+    // *this must be empty
+    constexpr auto copy_from(const fixed_capacity_vector &other) -> void {
+        if (detail::copyable_bitwise<T>()) {
+            std::memcpy(static_cast<void *>(begin()),
+                        static_cast<const void *>(other.begin()),
+                        other._sz * sizeof(T));
+            _sz = other._sz;
+            return;
+        }
+        for (; _sz < other._sz; _sz++)
+            std::construct_at(begin() + _sz, other[_sz]);
+    }
+
+    // *this must be empty, other is left empty
+    //  - if an element move throws, *this keeps the elements moved so far and
+    //    other keeps all of its elements
+    constexpr auto move_from(fixed_capacity_vector &other) noexcept(
+        std::is_nothrow_move_constructible_v<T>) -> void {
+        if constexpr (!std::is_nothrow_move_constructible_v<T>) {
+            if (!detail::relocatable_bitwise<T>()) {
+                for (; _sz < other._sz; _sz++)
+                    std::construct_at(begin() + _sz, std::move(other[_sz]));
+                other.clear();
+                return;
+            }
+        }
+        uninitialized_relocate(other.begin(), other.end(), begin());
+        _sz = std::exchange(other._sz, 0);
+    }
 
-    auto destroy_all() const noexcept -> void {
+    constexpr auto destroy_all() noexcept -> void {
         for (auto first = begin(), last = end(); first != last; first++) {
             std::destroy_at(first);
         }
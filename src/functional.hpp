@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cassert>
 #include <concepts>
+#include <cstddef>
 #include <exception>
+#include <functional>
 #include <memory>
+#include <new>
 #include <type_traits>
 #include <utility>
 
@@ -10,10 +14,91 @@ namespace mystd {
 
 namespace detail {
 
+// how a thunk takes its arguments, as std::function_ref does: scalars by
+// value, anything else by reference, so that the wrapper's `operator()` is
+// the only place an argument is copied
+template <class T>
+using param_t = std::conditional_t<std::is_scalar_v<T>, T, T &&>;
+
 template <class CallablePtr, class R, class... Args>
-inline auto do_call(void *callable_ptr, Args... args) -> R {
-    return (*reinterpret_cast<CallablePtr>(callable_ptr))(
-        std::forward<Args>(args)...);
+inline auto do_call(void *callable_ptr, param_t<Args>... args) -> R {
+    return std::invoke_r<R>(*reinterpret_cast<CallablePtr>(callable_ptr),
+                            std::forward<Args>(args)...);
+}
+
+// ****************************************************************************
+// *                        owning callable helper                            *
+// ****************************************************************************
+
+// a stored callable is called through do_call with the address of the
+// storage, which holds the callable itself or a pointer to it on the heap
+template <class F, class R, class... Args>
+inline auto do_call_heap(void *storage, param_t<Args>... args) -> R {
+    return do_call<F *, R, Args...>(*static_cast<void **>(storage),
+                                    std::forward<Args>(args)...);
+}
+
+// what a callable manager is asked to do, src and dst are storages
+//  - copy: copies the callable of src into dst, which holds nothing
+//  - move: moves the callable of src into dst, which holds nothing, src is
+//    left holding nothing
+//  - destroy: destroys the callable of src
+enum class callable_op { copy, move, destroy };
+
+template <class F>
+auto manage_inline(callable_op op, void *src, void *dst) -> void {
+    auto f = static_cast<F *>(src);
+    switch (op) {
+    case callable_op::copy:
+        if constexpr (std::copy_constructible<F>)
+            ::new (dst) F(*f);
+        break;
+    case callable_op::move:
+        ::new (dst) F(std::move(*f));
+        f->~F();
+        break;
+    case callable_op::destroy:
+        f->~F();
+        break;
+    }
+}
+
+template <class F>
+auto manage_heap(callable_op op, void *src, void *dst) -> void {
+    auto f = *static_cast<F **>(src);
+    switch (op) {
+    case callable_op::copy:
+        if constexpr (std::copy_constructible<F>)
+            *static_cast<F **>(dst) = new F(*f);
+        break;
+    case callable_op::move:
+        *static_cast<F **>(dst) = f;
+        break;
+    case callable_op::destroy:
+        delete f;
+        break;
+    }
+}
+
+// F is stored in a buffer of Size bytes aligned to Align
+template <class F, std::size_t Size, std::size_t Align>
+concept fits_callable_buffer = sizeof(F) <= Size && alignof(F) <= Align &&
+                               std::is_nothrow_move_constructible_v<F>;
+
+// the callables an owning wrapper of R(Args...) can be constructed from
+template <class F, class Self, class R, class... Args>
+concept stored_callable_for =
+    (!std::same_as<std::decay_t<F>, Self>) &&
+    std::constructible_from<std::decay_t<F>, F> &&
+    std::invocable<std::decay_t<F> &, Args...> &&
+    std::convertible_to<std::invoke_result_t<std::decay_t<F> &, Args...>, R>;
+
+// a null function pointer makes an empty wrapper
+template <class F> auto is_null_callable(const F &f) noexcept -> bool {
+    if constexpr (std::is_pointer_v<F>)
+        return f == nullptr;
+    else
+        return false;
 }
 
 // helper concept and type traits for deduction guides
@@ -31,6 +116,16 @@ struct memfn_sig<R (G::*)(Args...) const> {
     using type = R(Args...);
 };
 
+template <class R, class G, class... Args>
+struct memfn_sig<R (G::*)(Args...) noexcept> {
+    using type = R(Args...) noexcept;
+};
+
+template <class R, class G, class... Args>
+struct memfn_sig<R (G::*)(Args...) const noexcept> {
+    using type = R(Args...) noexcept;
+};
+
 template <class T> using memfn_sig_t = memfn_sig<T>::type;
 
 } // namespace detail
@@ -42,53 +137,492 @@ class bad_function_call : public std::exception {
     }
 };
 
+namespace detail {
+
+// called through an empty owning callable, so that calls need no check
+template <class R, class... Args>
+[[noreturn]] auto do_call_empty(void *, param_t<Args>...) -> R {
+    throw bad_function_call{};
+}
+
+} // namespace detail
+
 // ****************************************************************************
 // *                                 function_ref                             *
 // ****************************************************************************
 
-template <class>
-class function_ref; // undefined if template argument is not function signature
+// binds a function or member pointer at compile time, e.g.
+// `function_ref<int()>(nontype<&counter::next>, c)`
+template <auto f> struct nontype_t {
+    explicit nontype_t() = default;
+};
+
+template <auto f> inline constexpr nontype_t<f> nontype{};
+
+namespace detail {
+
+template <class> inline constexpr bool is_nontype = false;
+template <auto f> inline constexpr bool is_nontype<nontype_t<f>> = true;
 
-template <class R, class... Args> class function_ref<R(Args...)> {
-    using func_ptr_t = R (*)(Args...);
-    using do_call_t = R (*)(void *, Args...);
+// assigning anything but another function_ref, a function pointer or
+// nontype to a function_ref would leave a dangling reference
+template <class T, class Self>
+concept dangling_function_ref_assignment =
+    (!std::same_as<T, Self>) && (!std::is_pointer_v<T>) && (!is_nontype<T>);
+
+// the implementation of the 4 specializations of function_ref
+//  - Self is the specialization, Const and Noexcept are its qualifiers
+//  - the bound entity is the address of the callable, a function pointer,
+//    or nothing if f is bound with nontype, never null, so a call is one
+//    indirect call without a branch
+template <class Self, bool Const, bool Noexcept, class R, class... Args>
+class function_ref_base {
+    template <class T> using cv = std::conditional_t<Const, const T, T>;
+
+    template <class... T>
+    static constexpr bool is_invocable_using =
+        Noexcept ? std::is_nothrow_invocable_r_v<R, T..., Args...>
+                 : std::is_invocable_r_v<R, T..., Args...>;
+
+    using do_call_t = R (*)(void *, param_t<Args>...) noexcept(Noexcept);
 
   public:
     using result_type = R;
 
     // constructors
-    function_ref() noexcept : callable_ptr(nullptr), do_call_ptr(nullptr) {}
+    template <class F>
+        requires std::is_function_v<F> && is_invocable_using<F *>
+    function_ref_base(F *f) noexcept
+        : callable_ptr{reinterpret_cast<void *>(f)},
+          do_call_ptr{&call_function<F>} {
+        assert(f != nullptr && "function_ref cannot be null");
+    }
 
-    function_ref(func_ptr_t f_ptr) noexcept
-        : callable_ptr(reinterpret_cast<void *>(f_ptr)),
-          do_call_ptr(&detail::do_call<func_ptr_t, R, Args...>) {}
+    template <class F, class T = std::remove_reference_t<F>>
+        requires(!std::same_as<std::remove_cvref_t<F>, Self>) &&
+                (!std::is_member_pointer_v<T>) &&
+                (!std::is_function_v<T>) && is_invocable_using<cv<T> &>
+    function_ref_base(F &&f) noexcept
+        : callable_ptr{const_cast<void *>(
+              static_cast<const void *>(std::addressof(f)))},
+          do_call_ptr{&call_object<T>} {}
 
-    template <class F>
-        requires std::invocable<F, Args...> &&
-                     std::same_as<R, std::invoke_result_t<F, Args...>> &&
-                     (!std::same_as<std::remove_const_t<F>,
-                                    function_ref<R(Args...)>>)
-    function_ref(F &f) noexcept
-        : callable_ptr(&f), do_call_ptr(&detail::do_call<F *, R, Args...>) {}
+    template <auto f>
+        requires is_invocable_using<decltype(f)>
+    constexpr function_ref_base(nontype_t<f>) noexcept
+        : callable_ptr{nullptr}, do_call_ptr{&call_nontype<f>} {
+        check_nontype<f>();
+    }
 
-    auto operator()(Args... args) const -> R {
-        if (callable_ptr == nullptr)
-            throw bad_function_call{};
+    template <auto f, class U, class T = std::remove_reference_t<U>>
+        requires(!std::is_rvalue_reference_v<U &&>) &&
+                is_invocable_using<decltype(f), cv<T> &>
+    function_ref_base(nontype_t<f>, U &&obj) noexcept
+        : callable_ptr{const_cast<void *>(
+              static_cast<const void *>(std::addressof(obj)))},
+          do_call_ptr{&call_bound<f, T>} {
+        check_nontype<f>();
+    }
+
+    template <auto f, class T>
+        requires is_invocable_using<decltype(f), cv<T> *>
+    function_ref_base(nontype_t<f>, T *obj) noexcept
+        : callable_ptr{const_cast<void *>(static_cast<const void *>(obj))},
+          do_call_ptr{&call_bound_ptr<f, T>} {
+        check_nontype<f>();
+    }
+
+    // arguments are copied here once, and passed on by reference
+    auto operator()(Args... args) const noexcept(Noexcept) -> R {
         return do_call_ptr(callable_ptr, std::forward<Args>(args)...);
     }
 
   private:
     void *callable_ptr;
     do_call_t do_call_ptr;
+
+    template <auto f> static constexpr auto check_nontype() -> void {
+        if constexpr (std::is_pointer_v<decltype(f)>)
+            static_assert(f != nullptr, "nontype cannot bind null");
+    }
+
+    template <class F>
+    static auto call_function(void *f, param_t<Args>... args) noexcept(
+        Noexcept) -> R {
+        return std::invoke_r<R>(reinterpret_cast<F *>(f),
+                                std::forward<Args>(args)...);
+    }
+
+    template <class T>
+    static auto call_object(void *obj, param_t<Args>... args) noexcept(
+        Noexcept) -> R {
+        return std::invoke_r<R>(static_cast<cv<T> &>(*static_cast<T *>(obj)),
+                                std::forward<Args>(args)...);
+    }
+
+    template <auto f>
+    static auto call_nontype(void *, param_t<Args>... args) noexcept(Noexcept)
+        -> R {
+        return std::invoke_r<R>(f, std::forward<Args>(args)...);
+    }
+
+    template <auto f, class T>
+    static auto call_bound(void *obj, param_t<Args>... args) noexcept(Noexcept)
+        -> R {
+        return std::invoke_r<R>(f,
+                                static_cast<cv<T> &>(*static_cast<T *>(obj)),
+                                std::forward<Args>(args)...);
+    }
+
+    template <auto f, class T>
+    static auto call_bound_ptr(void *obj, param_t<Args>... args) noexcept(
+        Noexcept) -> R {
+        return std::invoke_r<R>(f, static_cast<cv<T> *>(static_cast<T *>(obj)),
+                                std::forward<Args>(args)...);
+    }
+};
+
+} // namespace detail
+
+template <class>
+class function_ref; // undefined if template argument is not function signature
+
+template <class R, class... Args>
+class function_ref<R(Args...)>
+    : public detail::function_ref_base<function_ref<R(Args...)>, false,
+                                       false, R, Args...> {
+    using base = detail::function_ref_base<function_ref, false, false, R,
+                                           Args...>;
+
+  public:
+    using base::base;
+
+    template <class T>
+        requires detail::dangling_function_ref_assignment<T, function_ref>
+    auto operator=(T) -> function_ref & = delete;
+};
+
+template <class R, class... Args>
+class function_ref<R(Args...) noexcept>
+    : public detail::function_ref_base<function_ref<R(Args...) noexcept>,
+                                       false, true, R, Args...> {
+    using base =
+        detail::function_ref_base<function_ref, false, true, R, Args...>;
+
+  public:
+    using base::base;
+
+    template <class T>
+        requires detail::dangling_function_ref_assignment<T, function_ref>
+    auto operator=(T) -> function_ref & = delete;
+};
+
+// the callable is called as const
+template <class R, class... Args>
+class function_ref<R(Args...) const>
+    : public detail::function_ref_base<function_ref<R(Args...) const>, true,
+                                       false, R, Args...> {
+    using base =
+        detail::function_ref_base<function_ref, true, false, R, Args...>;
+
+  public:
+    using base::base;
+
+    template <class T>
+        requires detail::dangling_function_ref_assignment<T, function_ref>
+    auto operator=(T) -> function_ref & = delete;
 };
 
-// deduction guides for std::function_ref
 template <class R, class... Args>
-function_ref(R (*)(Args...)) -> function_ref<R(Args...)>;
+class function_ref<R(Args...) const noexcept>
+    : public detail::function_ref_base<function_ref<R(Args...) const noexcept>,
+                                       true, true, R, Args...> {
+    using base =
+        detail::function_ref_base<function_ref, true, true, R, Args...>;
+
+  public:
+    using base::base;
+
+    template <class T>
+        requires detail::dangling_function_ref_assignment<T, function_ref>
+    auto operator=(T) -> function_ref & = delete;
+};
+
+// deduction guides for std::function_ref
+template <class F>
+    requires std::is_function_v<F>
+function_ref(F *) -> function_ref<F>;
+
+template <auto f>
+    requires std::is_function_v<std::remove_pointer_t<decltype(f)>>
+function_ref(nontype_t<f>) -> function_ref<std::remove_pointer_t<decltype(f)>>;
 
 template <detail::no_overload_callable F>
 function_ref(F) -> function_ref<detail::memfn_sig_t<decltype(&F::operator())>>;
 
+// ****************************************************************************
+// *                           move_only_function                             *
+// ****************************************************************************
+
+template <class, std::size_t BufferSize = 3 * sizeof(void *)>
+class move_only_function; // undefined if not a function signature
+
+// an owning callable that can be moved but not copied, for callbacks that
+// outlive their call site, e.g. tasks holding a unique_ptr
+//  - the callable is stored in a buffer of BufferSize bytes if it fits and
+//    is nothrow move constructible, otherwise on the heap
+//  - called through `do_call`, and moved and destroyed through one manager
+//    function, one pointer each
+//  - calling an empty move_only_function throws bad_function_call
+template <class R, class... Args, std::size_t BufferSize>
+class move_only_function<R(Args...), BufferSize> {
+    using do_call_t = R (*)(void *, detail::param_t<Args>...);
+    using manager_t = void (*)(detail::callable_op, void *, void *);
+
+  public:
+    using result_type = R;
+
+    // constructors
+    move_only_function() noexcept = default;
+    move_only_function(std::nullptr_t) noexcept {}
+
+    template <class F>
+        requires detail::stored_callable_for<F, move_only_function, R,
+                                             Args...>
+    move_only_function(F &&f) {
+        using D = std::decay_t<F>;
+        if (detail::is_null_callable(f))
+            return;
+        if constexpr (detail::fits_callable_buffer<D, BufferSize,
+                                                   alignof(void *)>) {
+            ::new (static_cast<void *>(_storage.buffer)) D(std::forward<F>(f));
+            do_call_ptr = &detail::do_call<D *, R, Args...>;
+            manager = &detail::manage_inline<D>;
+        } else {
+            _storage.heap = new D(std::forward<F>(f));
+            do_call_ptr = &detail::do_call_heap<D, R, Args...>;
+            manager = &detail::manage_heap<D>;
+        }
+    }
+
+    move_only_function(move_only_function &&other) noexcept { take(other); }
+
+    // destructor
+    ~move_only_function() { reset(); }
+
+    // assignments
+    auto operator=(move_only_function &&rhs) noexcept -> move_only_function & {
+        if (this == &rhs)
+            return *this;
+        reset();
+        take(rhs);
+        return *this;
+    }
+
+    auto operator=(std::nullptr_t) noexcept -> move_only_function & {
+        reset();
+        return *this;
+    }
+
+    template <class F>
+        requires detail::stored_callable_for<F, move_only_function, R,
+                                             Args...>
+    auto operator=(F &&f) -> move_only_function & {
+        return *this = move_only_function(std::forward<F>(f));
+    }
+
+    // modifiers
+    auto swap(move_only_function &other) noexcept -> void {
+        move_only_function tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend auto swap(move_only_function &lhs, move_only_function &rhs) noexcept
+        -> void {
+        lhs.swap(rhs);
+    }
+
+    // observers
+    explicit operator bool() const noexcept { return manager != nullptr; }
+
+    friend auto operator==(const move_only_function &f, std::nullptr_t) noexcept
+        -> bool {
+        return !f;
+    }
+
+    auto operator()(Args... args) -> R {
+        return do_call_ptr(&_storage, std::forward<Args>(args)...);
+    }
+
+  private:
+    // a BufferSize of 0 stores every callable on the heap
+    union storage {
+        void *heap;
+        alignas(void *) std::byte
+            buffer[BufferSize > sizeof(void *) ? BufferSize : sizeof(void *)];
+    } _storage;
+    do_call_t do_call_ptr = &detail::do_call_empty<R, Args...>;
+    manager_t manager = nullptr;
+
+    auto reset() noexcept -> void {
+        if (manager != nullptr) {
+            manager(detail::callable_op::destroy, &_storage, nullptr);
+            do_call_ptr = &detail::do_call_empty<R, Args...>;
+            manager = nullptr;
+        }
+    }
+
+    // moves the callable out of other, which is left empty
+    auto take(move_only_function &other) noexcept -> void {
+        if (other.manager != nullptr) {
+            other.manager(detail::callable_op::move, &other._storage,
+                          &_storage);
+            do_call_ptr = std::exchange(other.do_call_ptr,
+                                        &detail::do_call_empty<R, Args...>);
+            manager = std::exchange(other.manager, nullptr);
+        }
+    }
+};
+
+// ****************************************************************************
+// *                             inplace_function                             *
+// ****************************************************************************
+
+template <class, std::size_t Capacity = 4 * sizeof(void *)>
+class inplace_function; // undefined if not a function signature
+
+// an owning, copyable callable that never allocates, e.g. for event loop
+// callbacks and task queues
+//  - the callable must fit in Capacity bytes aligned as std::max_align_t and
+//    be nothrow move constructible, otherwise it does not compile
+//  - like std::function, `operator()` is const and calls the callable as
+//    non-const
+//  - calling an empty inplace_function throws bad_function_call
+template <class R, class... Args, std::size_t Capacity>
+class inplace_function<R(Args...), Capacity> {
+    using do_call_t = R (*)(void *, detail::param_t<Args>...);
+    using manager_t = void (*)(detail::callable_op, void *, void *);
+
+  public:
+    using result_type = R;
+
+    // constructors
+    inplace_function() noexcept = default;
+    inplace_function(std::nullptr_t) noexcept {}
+
+    template <class F>
+        requires detail::stored_callable_for<F, inplace_function, R,
+                                             Args...> &&
+                 std::copy_constructible<std::decay_t<F>>
+    inplace_function(F &&f) {
+        using D = std::decay_t<F>;
+        static_assert(sizeof(D) <= Capacity,
+                      "callable too large for inplace_function, increase "
+                      "its Capacity");
+        static_assert(alignof(D) <= alignof(std::max_align_t),
+                      "callable over-aligned for inplace_function");
+        static_assert(std::is_nothrow_move_constructible_v<D>,
+                      "callable of inplace_function must be nothrow move "
+                      "constructible");
+        if (detail::is_null_callable(f))
+            return;
+        ::new (static_cast<void *>(_buffer)) D(std::forward<F>(f));
+        do_call_ptr = &detail::do_call<D *, R, Args...>;
+        manager = &detail::manage_inline<D>;
+    }
+
+    inplace_function(const inplace_function &other)
+        : do_call_ptr{other.do_call_ptr}, manager{other.manager} {
+        if (manager != nullptr)
+            manager(detail::callable_op::copy, other._buffer, _buffer);
+    }
+
+    inplace_function(inplace_function &&other) noexcept { take(other); }
+
+    // destructor
+    ~inplace_function() { reset(); }
+
+    // assignments
+    auto operator=(const inplace_function &rhs) -> inplace_function & {
+        if (this == &rhs)
+            return *this;
+        // copied first, the callable may throw
+        inplace_function copy(rhs);
+        reset();
+        take(copy);
+        return *this;
+    }
+
+    auto operator=(inplace_function &&rhs) noexcept -> inplace_function & {
+        if (this == &rhs)
+            return *this;
+        reset();
+        take(rhs);
+        return *this;
+    }
+
+    auto operator=(std::nullptr_t) noexcept -> inplace_function & {
+        reset();
+        return *this;
+    }
+
+    template <class F>
+        requires detail::stored_callable_for<F, inplace_function, R,
+                                             Args...> &&
+                 std::copy_constructible<std::decay_t<F>>
+    auto operator=(F &&f) -> inplace_function & {
+        return *this = inplace_function(std::forward<F>(f));
+    }
+
+    // modifiers
+    auto swap(inplace_function &other) noexcept -> void {
+        inplace_function tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend auto swap(inplace_function &lhs, inplace_function &rhs) noexcept
+        -> void {
+        lhs.swap(rhs);
+    }
+
+    // observers
+    explicit operator bool() const noexcept { return manager != nullptr; }
+
+    friend auto operator==(const inplace_function &f, std::nullptr_t) noexcept
+        -> bool {
+        return !f;
+    }
+
+    auto operator()(Args... args) const -> R {
+        return do_call_ptr(_buffer, std::forward<Args>(args)...);
+    }
+
+  private:
+    alignas(std::max_align_t) mutable std::byte _buffer[Capacity];
+    do_call_t do_call_ptr = &detail::do_call_empty<R, Args...>;
+    manager_t manager = nullptr;
+
+    auto reset() noexcept -> void {
+        if (manager != nullptr) {
+            manager(detail::callable_op::destroy, _buffer, nullptr);
+            do_call_ptr = &detail::do_call_empty<R, Args...>;
+            manager = nullptr;
+        }
+    }
+
+    // moves the callable out of other, which is left empty
+    auto take(inplace_function &other) noexcept -> void {
+        if (other.manager != nullptr) {
+            other.manager(detail::callable_op::move, other._buffer, _buffer);
+            do_call_ptr = std::exchange(other.do_call_ptr,
+                                        &detail::do_call_empty<R, Args...>);
+            manager = std::exchange(other.manager, nullptr);
+        }
+    }
+};
+
 // ****************************************************************************
 // *                            reference_wrapper                             *
 // ****************************************************************************
@@ -0,0 +1,624 @@
+#pragma once
+
+#include "span.hpp"
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace mystd {
+
+// ****************************************************************************
+// *                                 extents                                  *
+// ****************************************************************************
+
+// the extents of a multidimensional index space, each one static or
+// `dynamic_extent`
+//  - only the dynamic extents are stored, as in span, `extents<int, 3, 4>`
+//    is empty
+template <class IndexType, std::size_t... Extents> class extents {
+    static_assert(std::is_integral_v<IndexType> &&
+                  !std::is_same_v<IndexType, bool>);
+
+    static constexpr std::size_t _rank = sizeof...(Extents);
+    static constexpr std::size_t _rank_dynamic =
+        ((Extents == dynamic_extent) + ... + 0);
+    static constexpr std::array<std::size_t, _rank> _static_extents{
+        Extents...};
+
+    // the position of each extent among the dynamic ones
+    static constexpr std::array<std::size_t, _rank> _dynamic_index = [] {
+        std::array<std::size_t, _rank> index{};
+        std::size_t d = 0;
+        for (std::size_t r = 0; r < _rank; r++) {
+            index[r] = d;
+            if (_static_extents[r] == dynamic_extent)
+                d++;
+        }
+        return index;
+    }();
+
+  public:
+    // member types
+    using index_type = IndexType;
+    using size_type = std::make_unsigned_t<IndexType>;
+    using rank_type = std::size_t;
+
+    // observers
+    static constexpr auto rank() noexcept -> rank_type { return _rank; }
+    static constexpr auto rank_dynamic() noexcept -> rank_type {
+        return _rank_dynamic;
+    }
+    static constexpr auto static_extent(rank_type r) noexcept -> std::size_t {
+        return _static_extents[r];
+    }
+
+    constexpr auto extent(rank_type r) const noexcept -> index_type {
+        if constexpr (_rank_dynamic == 0) {
+            return static_cast<index_type>(_static_extents[r]);
+        } else {
+            if (_static_extents[r] != dynamic_extent)
+                return static_cast<index_type>(_static_extents[r]);
+            return _dynamic[_dynamic_index[r]];
+        }
+    }
+
+    // constructors
+    //  - dynamic extents are 0 by default
+    //  - from the dynamic extents, or from all extents, in which case the
+    //    static ones must match
+    constexpr extents() noexcept = default;
+
+    template <class... OtherIndexType>
+        requires(sizeof...(OtherIndexType) == _rank_dynamic ||
+                 sizeof...(OtherIndexType) == _rank) &&
+                (std::convertible_to<OtherIndexType, index_type> && ...)
+    constexpr explicit extents(OtherIndexType... exts) noexcept {
+        const std::array<index_type, sizeof...(OtherIndexType)> given{
+            static_cast<index_type>(exts)...};
+        if constexpr (sizeof...(OtherIndexType) == _rank_dynamic) {
+            for (std::size_t d = 0; d < _rank_dynamic; d++)
+                _dynamic[d] = given[d];
+        } else {
+            for (std::size_t r = 0; r < _rank; r++) {
+                if (_static_extents[r] == dynamic_extent)
+                    _dynamic[_dynamic_index[r]] = given[r];
+                else
+                    assert(static_cast<std::size_t>(given[r]) ==
+                           _static_extents[r]);
+            }
+        }
+    }
+
+    // comparison
+    template <class OtherIndexType, std::size_t... OtherExtents>
+    friend constexpr auto
+    operator==(const extents &lhs,
+               const extents<OtherIndexType, OtherExtents...> &rhs) noexcept
+        -> bool {
+        if constexpr (sizeof...(OtherExtents) != _rank) {
+            return false;
+        } else {
+            for (std::size_t r = 0; r < _rank; r++)
+                if (static_cast<std::size_t>(lhs.extent(r)) !=
+                    static_cast<std::size_t>(rhs.extent(r)))
+                    return false;
+            return true;
+        }
+    }
+
+  private:
+    struct _empty {};
+    [[no_unique_address]] std::conditional_t<
+        _rank_dynamic == 0, _empty, std::array<index_type, _rank_dynamic>>
+        _dynamic{};
+};
+
+namespace detail {
+
+template <class IndexType, std::size_t Rank,
+          class = std::make_index_sequence<Rank>>
+struct dextents_impl;
+
+template <class IndexType, std::size_t Rank, std::size_t... Is>
+struct dextents_impl<IndexType, Rank, std::index_sequence<Is...>> {
+    using type = extents<IndexType, ((void)Is, dynamic_extent)...>;
+};
+
+// the product of the extents in [first, last)
+template <class Extents>
+constexpr auto extents_product(const Extents &e, std::size_t first,
+                               std::size_t last) noexcept ->
+    typename Extents::index_type {
+    typename Extents::index_type product = 1;
+    for (std::size_t r = first; r < last; r++)
+        product *= e.extent(r);
+    return product;
+}
+
+template <class Extents, class... Indices>
+concept indices_for =
+    sizeof...(Indices) == Extents::rank() &&
+    (std::convertible_to<Indices, typename Extents::index_type> && ...);
+
+} // namespace detail
+
+// all extents dynamic
+template <class IndexType, std::size_t Rank>
+using dextents = typename detail::dextents_impl<IndexType, Rank>::type;
+
+// ****************************************************************************
+// *                                 layouts                                  *
+// ****************************************************************************
+
+// a layout maps a multidimensional index to an offset in the data
+//  - `layout_right`: row major, the last index is contiguous, as in C
+//  - `layout_left`: column major, the first index is contiguous, as in
+//    Fortran and BLAS
+//  - `layout_stride`: any stride for each index, e.g. a column of a row major
+//    matrix, or a transposed view
+//  - `layout_tiled<TileRows, TileCols>`: a matrix stored as contiguous tiles,
+//    so that a tile stays in cache whichever way it is walked
+// a kernel written against `m[i, j]` works with all of them
+
+struct layout_right {
+    template <class Extents> class mapping;
+};
+
+struct layout_left {
+    template <class Extents> class mapping;
+};
+
+struct layout_stride {
+    template <class Extents> class mapping;
+};
+
+template <std::size_t TileRows, std::size_t TileCols> struct layout_tiled {
+    template <class Extents> class mapping;
+};
+
+template <class Extents> class layout_right::mapping {
+  public:
+    using extents_type = Extents;
+    using index_type = typename Extents::index_type;
+    using size_type = typename Extents::size_type;
+    using rank_type = typename Extents::rank_type;
+    using layout_type = layout_right;
+
+    constexpr mapping() noexcept = default;
+    constexpr mapping(const extents_type &e) noexcept : _extents{e} {}
+
+    constexpr auto extents() const noexcept -> const extents_type & {
+        return _extents;
+    }
+
+    constexpr auto required_span_size() const noexcept -> index_type {
+        return detail::extents_product(_extents, 0, Extents::rank());
+    }
+
+    // ((i0 * e1 + i1) * e2 + i2) ...
+    template <class... Indices>
+        requires detail::indices_for<Extents, Indices...>
+    constexpr auto operator()(Indices... is) const noexcept -> index_type {
+        index_type offset = 0;
+        [[maybe_unused]] rank_type r = 0;
+        ((offset = offset * _extents.extent(r++) + static_cast<index_type>(is)),
+         ...);
+        return offset;
+    }
+
+    constexpr auto stride(rank_type r) const noexcept -> index_type {
+        return detail::extents_product(_extents, r + 1, Extents::rank());
+    }
+
+    static constexpr auto is_always_unique() noexcept -> bool { return true; }
+    static constexpr auto is_always_exhaustive() noexcept -> bool {
+        return true;
+    }
+    static constexpr auto is_always_strided() noexcept -> bool { return true; }
+    static constexpr auto is_unique() noexcept -> bool { return true; }
+    static constexpr auto is_exhaustive() noexcept -> bool { return true; }
+    static constexpr auto is_strided() noexcept -> bool { return true; }
+
+    friend constexpr auto operator==(const mapping &lhs,
+                                     const mapping &rhs) noexcept -> bool {
+        return lhs._extents == rhs._extents;
+    }
+
+  private:
+    [[no_unique_address]] extents_type _extents{};
+};
+
+template <class Extents> class layout_left::mapping {
+  public:
+    using extents_type = Extents;
+    using index_type = typename Extents::index_type;
+    using size_type = typename Extents::size_type;
+    using rank_type = typename Extents::rank_type;
+    using layout_type = layout_left;
+
+    constexpr mapping() noexcept = default;
+    constexpr mapping(const extents_type &e) noexcept : _extents{e} {}
+
+    constexpr auto extents() const noexcept -> const extents_type & {
+        return _extents;
+    }
+
+    constexpr auto required_span_size() const noexcept -> index_type {
+        return detail::extents_product(_extents, 0, Extents::rank());
+    }
+
+    // i0 + e0 * (i1 + e1 * (i2 + ...))
+    template <class... Indices>
+        requires detail::indices_for<Extents, Indices...>
+    constexpr auto operator()(Indices... is) const noexcept -> index_type {
+        index_type offset = 0;
+        [[maybe_unused]] index_type stride = 1;
+        [[maybe_unused]] rank_type r = 0;
+        ((offset += static_cast<index_type>(is) * stride,
+          stride *= _extents.extent(r++)),
+         ...);
+        return offset;
+    }
+
+    constexpr auto stride(rank_type r) const noexcept -> index_type {
+        return detail::extents_product(_extents, 0, r);
+    }
+
+    static constexpr auto is_always_unique() noexcept -> bool { return true; }
+    static constexpr auto is_always_exhaustive() noexcept -> bool {
+        return true;
+    }
+    static constexpr auto is_always_strided() noexcept -> bool { return true; }
+    static constexpr auto is_unique() noexcept -> bool { return true; }
+    static constexpr auto is_exhaustive() noexcept -> bool { return true; }
+    static constexpr auto is_strided() noexcept -> bool { return true; }
+
+    friend constexpr auto operator==(const mapping &lhs,
+                                     const mapping &rhs) noexcept -> bool {
+        return lhs._extents == rhs._extents;
+    }
+
+  private:
+    [[no_unique_address]] extents_type _extents{};
+};
+
+template <class Extents> class layout_stride::mapping {
+  public:
+    using extents_type = Extents;
+    using index_type = typename Extents::index_type;
+    using size_type = typename Extents::size_type;
+    using rank_type = typename Extents::rank_type;
+    using layout_type = layout_stride;
+
+    // layout_right by default
+    constexpr mapping() noexcept
+        : mapping(layout_right::mapping<Extents>{}) {}
+
+    constexpr mapping(const extents_type &e,
+                      const std::array<index_type, Extents::rank()> &strides)
+        noexcept
+        : _extents{e}, _strides{strides} {}
+
+    // from any strided mapping, e.g. layout_right or layout_left
+    template <class Mapping>
+        requires std::same_as<typename Mapping::extents_type, Extents> &&
+                 (Mapping::is_always_strided())
+    constexpr mapping(const Mapping &other) noexcept
+        : _extents{other.extents()} {
+        for (std::size_t r = 0; r < Extents::rank(); r++)
+            _strides[r] = other.stride(r);
+    }
+
+    constexpr auto extents() const noexcept -> const extents_type & {
+        return _extents;
+    }
+
+    constexpr auto strides() const noexcept
+        -> const std::array<index_type, Extents::rank()> & {
+        return _strides;
+    }
+
+    // one past the largest offset
+    constexpr auto required_span_size() const noexcept -> index_type {
+        index_type size = 1;
+        for (std::size_t r = 0; r < Extents::rank(); r++) {
+            if (_extents.extent(r) == 0)
+                return 0;
+            size += (_extents.extent(r) - 1) * _strides[r];
+        }
+        return size;
+    }
+
+    template <class... Indices>
+        requires detail::indices_for<Extents, Indices...>
+    constexpr auto operator()(Indices... is) const noexcept -> index_type {
+        index_type offset = 0;
+        [[maybe_unused]] rank_type r = 0;
+        ((offset += static_cast<index_type>(is) * _strides[r++]), ...);
+        return offset;
+    }
+
+    constexpr auto stride(rank_type r) const noexcept -> index_type {
+        return _strides[r];
+    }
+
+    // the strides must not map two indices to the same offset
+    static constexpr auto is_always_unique() noexcept -> bool { return true; }
+    static constexpr auto is_always_exhaustive() noexcept -> bool {
+        return false;
+    }
+    static constexpr auto is_always_strided() noexcept -> bool { return true; }
+    static constexpr auto is_unique() noexcept -> bool { return true; }
+    static constexpr auto is_strided() noexcept -> bool { return true; }
+
+    // every offset below required_span_size is used
+    constexpr auto is_exhaustive() const noexcept -> bool {
+        return required_span_size() ==
+               detail::extents_product(_extents, 0, Extents::rank());
+    }
+
+    friend constexpr auto operator==(const mapping &lhs,
+                                     const mapping &rhs) noexcept -> bool {
+        return lhs._extents == rhs._extents && lhs._strides == rhs._strides;
+    }
+
+  private:
+    [[no_unique_address]] extents_type _extents{};
+    std::array<index_type, Extents::rank()> _strides{};
+};
+
+// tiles of TileRows x TileCols elements are stored one after another in row
+// major order, and the elements of a tile in row major order
+//  - matrices only
+//  - the last row and column of tiles are padded if the extents are not
+//    multiples of the tile size, the mapping is not exhaustive then
+//  - not strided, `stride` is not defined
+//  - tile sizes that are powers of two make the divisions shifts
+template <std::size_t TileRows, std::size_t TileCols>
+template <class Extents>
+class layout_tiled<TileRows, TileCols>::mapping {
+    static_assert(Extents::rank() == 2, "layout_tiled maps matrices");
+    static_assert(TileRows > 0 && TileCols > 0);
+
+  public:
+    using extents_type = Extents;
+    using index_type = typename Extents::index_type;
+    using size_type = typename Extents::size_type;
+    using rank_type = typename Extents::rank_type;
+    using layout_type = layout_tiled;
+
+    static constexpr index_type tile_rows = TileRows;
+    static constexpr index_type tile_cols = TileCols;
+    static constexpr index_type tile_size = tile_rows * tile_cols;
+
+    constexpr mapping() noexcept = default;
+    constexpr mapping(const extents_type &e) noexcept : _extents{e} {}
+
+    constexpr auto extents() const noexcept -> const extents_type & {
+        return _extents;
+    }
+
+    constexpr auto tiles_per_row() const noexcept -> index_type {
+        return (_extents.extent(1) + tile_cols - 1) / tile_cols;
+    }
+
+    constexpr auto tiles_per_col() const noexcept -> index_type {
+        return (_extents.extent(0) + tile_rows - 1) / tile_rows;
+    }
+
+    constexpr auto required_span_size() const noexcept -> index_type {
+        return tiles_per_col() * tiles_per_row() * tile_size;
+    }
+
+    template <class I, class J>
+        requires detail::indices_for<Extents, I, J>
+    constexpr auto operator()(I i, J j) const noexcept -> index_type {
+        auto row = static_cast<index_type>(i);
+        auto col = static_cast<index_type>(j);
+        auto tile = (row / tile_rows) * tiles_per_row() + col / tile_cols;
+        return tile * tile_size + (row % tile_rows) * tile_cols +
+               col % tile_cols;
+    }
+
+    static constexpr auto is_always_unique() noexcept -> bool { return true; }
+    static constexpr auto is_always_exhaustive() noexcept -> bool {
+        return false;
+    }
+    static constexpr auto is_always_strided() noexcept -> bool {
+        return false;
+    }
+    static constexpr auto is_unique() noexcept -> bool { return true; }
+    static constexpr auto is_strided() noexcept -> bool { return false; }
+
+    constexpr auto is_exhaustive() const noexcept -> bool {
+        return _extents.extent(0) % tile_rows == 0 &&
+               _extents.extent(1) % tile_cols == 0;
+    }
+
+    friend constexpr auto operator==(const mapping &lhs,
+                                     const mapping &rhs) noexcept -> bool {
+        return lhs._extents == rhs._extents;
+    }
+
+  private:
+    [[no_unique_address]] extents_type _extents{};
+};
+
+// ****************************************************************************
+// *                                  mdspan                                  *
+// ****************************************************************************
+
+template <class ElementType> struct default_accessor {
+    using offset_policy = default_accessor;
+    using element_type = ElementType;
+    using reference = ElementType &;
+    using data_handle_type = ElementType *;
+
+    constexpr auto access(data_handle_type p, std::size_t i) const noexcept
+        -> reference {
+        return p[i];
+    }
+
+    constexpr auto offset(data_handle_type p, std::size_t i) const noexcept
+        -> data_handle_type {
+        return p + i;
+    }
+};
+
+// a multidimensional view of contiguous data, e.g. a matrix stored in a
+// vector, indexed with `m[i, j]`
+//  - the layout policy maps indices to offsets, the accessor policy turns an
+//    offset into a reference
+//  - a pointer, the stored extents and strides, nothing else: an mdspan of
+//    static extents with layout_right is one pointer
+template <class ElementType, class Extents, class LayoutPolicy = layout_right,
+          class AccessorPolicy = default_accessor<ElementType>>
+class mdspan {
+  public:
+    // member types
+    using extents_type = Extents;
+    using layout_type = LayoutPolicy;
+    using accessor_type = AccessorPolicy;
+    using mapping_type = typename LayoutPolicy::template mapping<Extents>;
+    using element_type = ElementType;
+    using value_type = std::remove_cv_t<ElementType>;
+    using index_type = typename Extents::index_type;
+    using size_type = typename Extents::size_type;
+    using rank_type = typename Extents::rank_type;
+    using data_handle_type = typename AccessorPolicy::data_handle_type;
+    using reference = typename AccessorPolicy::reference;
+
+    // observers of the extents
+    static constexpr auto rank() noexcept -> rank_type {
+        return Extents::rank();
+    }
+    static constexpr auto rank_dynamic() noexcept -> rank_type {
+        return Extents::rank_dynamic();
+    }
+    static constexpr auto static_extent(rank_type r) noexcept -> std::size_t {
+        return Extents::static_extent(r);
+    }
+    constexpr auto extent(rank_type r) const noexcept -> index_type {
+        return extents().extent(r);
+    }
+
+    // constructors
+    constexpr mdspan()
+        requires(rank_dynamic() > 0)
+    = default;
+
+    template <class... OtherIndexType>
+        requires(sizeof...(OtherIndexType) == rank() ||
+                 sizeof...(OtherIndexType) == rank_dynamic()) &&
+                (std::convertible_to<OtherIndexType, index_type> && ...)
+    constexpr explicit mdspan(data_handle_type p, OtherIndexType... exts)
+        : _ptr{std::move(p)},
+          _map{extents_type(static_cast<index_type>(exts)...)} {}
+
+    constexpr mdspan(data_handle_type p, const extents_type &e)
+        : _ptr{std::move(p)}, _map{e} {}
+
+    constexpr mdspan(data_handle_type p, const mapping_type &m)
+        : _ptr{std::move(p)}, _map{m} {}
+
+    constexpr mdspan(data_handle_type p, const mapping_type &m,
+                     const accessor_type &a)
+        : _ptr{std::move(p)}, _map{m}, _acc{a} {}
+
+    // over a span, which must be large enough for the mapping
+    template <std::size_t SpanExtent>
+    constexpr mdspan(span<element_type, SpanExtent> s, const mapping_type &m)
+        : _ptr{s.data()}, _map{m} {
+        assert(static_cast<std::size_t>(m.required_span_size()) <= s.size());
+    }
+
+    template <std::size_t SpanExtent>
+    constexpr mdspan(span<element_type, SpanExtent> s, const extents_type &e)
+        : mdspan(s, mapping_type(e)) {}
+
+    // element access
+    template <class... OtherIndexType>
+        requires detail::indices_for<Extents, OtherIndexType...>
+    constexpr auto operator[](OtherIndexType... is) const -> reference {
+        return _acc.access(_ptr, static_cast<std::size_t>(_map(
+                                     static_cast<index_type>(is)...)));
+    }
+
+    // observers
+    constexpr auto size() const noexcept -> size_type {
+        return static_cast<size_type>(
+            detail::extents_product(extents(), 0, rank()));
+    }
+    constexpr auto empty() const noexcept -> bool { return size() == 0; }
+
+    constexpr auto extents() const noexcept -> const extents_type & {
+        return _map.extents();
+    }
+    constexpr auto data_handle() const noexcept -> const data_handle_type & {
+        return _ptr;
+    }
+    constexpr auto mapping() const noexcept -> const mapping_type & {
+        return _map;
+    }
+    constexpr auto accessor() const noexcept -> const accessor_type & {
+        return _acc;
+    }
+
+    static constexpr auto is_always_unique() -> bool {
+        return mapping_type::is_always_unique();
+    }
+    static constexpr auto is_always_exhaustive() -> bool {
+        return mapping_type::is_always_exhaustive();
+    }
+    static constexpr auto is_always_strided() -> bool {
+        return mapping_type::is_always_strided();
+    }
+    constexpr auto is_unique() const -> bool { return _map.is_unique(); }
+    constexpr auto is_exhaustive() const -> bool {
+        return _map.is_exhaustive();
+    }
+    constexpr auto is_strided() const -> bool { return _map.is_strided(); }
+    constexpr auto stride(rank_type r) const -> index_type
+        requires(mapping_type::is_always_strided())
+    {
+        return _map.stride(r);
+    }
+
+  private:
+    data_handle_type _ptr{};
+    [[no_unique_address]] mapping_type _map{};
+    [[no_unique_address]] accessor_type _acc{};
+};
+
+// deduction guides, integral extents make dynamic extents of size_t
+template <class ElementType, class... Integrals>
+    requires(sizeof...(Integrals) > 0) &&
+            (std::convertible_to<Integrals, std::size_t> && ...)
+explicit mdspan(ElementType *, Integrals...)
+    -> mdspan<ElementType, dextents<std::size_t, sizeof...(Integrals)>>;
+
+template <class ElementType, class IndexType, std::size_t... Extents>
+mdspan(ElementType *, const extents<IndexType, Extents...> &)
+    -> mdspan<ElementType, extents<IndexType, Extents...>>;
+
+template <class ElementType, class Mapping>
+    requires requires { typename Mapping::layout_type; }
+mdspan(ElementType *, const Mapping &)
+    -> mdspan<ElementType, typename Mapping::extents_type,
+              typename Mapping::layout_type>;
+
+template <class ElementType, std::size_t SpanExtent, class IndexType,
+          std::size_t... Extents>
+mdspan(span<ElementType, SpanExtent>, const extents<IndexType, Extents...> &)
+    -> mdspan<ElementType, extents<IndexType, Extents...>>;
+
+template <class ElementType, std::size_t SpanExtent, class Mapping>
+    requires requires { typename Mapping::layout_type; }
+mdspan(span<ElementType, SpanExtent>, const Mapping &)
+    -> mdspan<ElementType, typename Mapping::extents_type,
+              typename Mapping::layout_type>;
+
+} // namespace mystd
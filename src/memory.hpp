@@ -1,3 +1,10 @@
+#pragma once
 
+#include "allocators/fixed_size_pool.hpp"
+#include "allocators/malloc_allocator.hpp"
+#include "allocators/monotonic_arena.hpp"
+#include "smart_pointers/atomic_shared_ptr.hpp"
+#include "smart_pointers/deferred_delete.hpp"
+#include "smart_pointers/intrusive_ptr.hpp"
 #include "smart_pointers/shared_ptr.hpp"
-#include "smart_pointers/unique_ptr.hpp"
\ No newline at end of file
+#include "smart_pointers/unique_ptr.hpp"
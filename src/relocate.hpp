@@ -0,0 +1,277 @@
+#pragma once
+
+#include "scope.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace mystd {
+
+namespace detail {
+
+template <class T>
+concept has_trivially_relocatable_tag =
+    requires { typename T::trivially_relocatable; };
+
+} // namespace detail
+
+// ****************************************************************************
+// *                        is_trivially_relocatable                          *
+// ****************************************************************************
+
+// a type is trivially relocatable if moving an object to a new address and
+// ending the lifetime of the old one is equivalent to a memcpy of its bytes
+//  - trivially copyable types are detected automatically
+//  - class types can opt in with a member tag:
+//      `using trivially_relocatable = std::true_type;`
+//  - other types can opt in by specializing `is_trivially_relocatable`
+template <class T>
+struct is_trivially_relocatable
+    : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <class T>
+    requires detail::has_trivially_relocatable_tag<T>
+struct is_trivially_relocatable<T>
+    : std::bool_constant<T::trivially_relocatable::value> {};
+
+template <class T, std::size_t N>
+struct is_trivially_relocatable<T[N]> : is_trivially_relocatable<T> {};
+
+// stateless, but has a user-provided copy constructor
+template <class T>
+struct is_trivially_relocatable<std::allocator<T>> : std::true_type {};
+
+template <class T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+namespace detail {
+
+// memcpy cannot be used in constant evaluation, so the bitwise path is only
+// taken at runtime
+template <class T> constexpr auto relocatable_bitwise() noexcept -> bool {
+    return is_trivially_relocatable_v<T> && !std::is_constant_evaluated();
+}
+
+template <class T> constexpr auto copyable_bitwise() noexcept -> bool {
+    return std::is_trivially_copyable_v<T> && !std::is_constant_evaluated();
+}
+
+// how the helpers below construct and destroy elements
+//  - `plain_construct` for the containers without an allocator
+//  - `allocator_construct` goes through allocator_traits, so that allocators
+//    customizing `construct`, e.g. scoped_allocator_adaptor, see every
+//    element a vector creates
+struct plain_construct {
+    template <class T, class... Args>
+    constexpr auto construct(T *p, Args &&...args) const -> void {
+        std::construct_at(p, std::forward<Args>(args)...);
+    }
+    template <class T> constexpr auto destroy(T *p) const noexcept -> void {
+        std::destroy_at(p);
+    }
+};
+
+template <class Alloc> struct allocator_construct {
+    Alloc &alloc;
+
+    template <class T, class... Args>
+    constexpr auto construct(T *p, Args &&...args) const -> void {
+        std::allocator_traits<Alloc>::construct(alloc, p,
+                                                std::forward<Args>(args)...);
+    }
+    template <class T> constexpr auto destroy(T *p) const noexcept -> void {
+        std::allocator_traits<Alloc>::destroy(alloc, p);
+    }
+};
+
+template <class T, class Construct>
+constexpr auto destroy_range(T *first, T *last, const Construct &c) noexcept
+    -> void {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (; first != last; ++first)
+            c.destroy(first);
+    }
+}
+
+} // namespace detail
+
+// ****************************************************************************
+// *                         uninitialized_relocate                           *
+// ****************************************************************************
+
+// move [first, last) into the uninitialized storage starting at d_first and
+// end the lifetime of the source objects, the two ranges must not overlap
+template <class T>
+constexpr auto uninitialized_relocate(T *first, T *last, T *d_first) -> T * {
+    if (detail::relocatable_bitwise<T>()) {
+        auto n = static_cast<std::size_t>(last - first);
+        if (n > 0)
+            std::memcpy(static_cast<void *>(d_first),
+                        static_cast<const void *>(first), n * sizeof(T));
+        return d_first + n;
+    }
+
+    for (; first != last; ++first, ++d_first) {
+        std::construct_at(d_first, std::move(*first));
+        std::destroy_at(first);
+    }
+    return d_first;
+}
+
+// ****************************************************************************
+// *                     uninitialized_move_if_noexcept                       *
+// ****************************************************************************
+
+// move [first, last) into the uninitialized storage starting at d_first,
+// elements are copied instead if their move constructor may throw
+//  - if a copy throws, the copies made so far are destroyed and the source is
+//    untouched, which gives the strong guarantee
+//  - if T is only movable and its move throws, the source is left partially
+//    moved-from
+//  - the rollback bookkeeping is only compiled for such throwing types
+//  - elements are constructed and destroyed through c, e.g. through the
+//    allocator of a vector
+template <class T, class Construct = detail::plain_construct>
+constexpr auto uninitialized_move_if_noexcept(T *first, T *last, T *d_first,
+                                              const Construct &c = {}) -> T * {
+    if constexpr (std::is_nothrow_move_constructible_v<T>) {
+        for (; first != last; ++first, ++d_first)
+            c.construct(d_first, std::move(*first));
+        return d_first;
+    } else {
+        auto cur = d_first;
+        scope_exit guard{[&] { detail::destroy_range(d_first, cur, c); }};
+        for (; first != last; ++first, ++cur)
+            c.construct(cur, std::move_if_noexcept(*first));
+        guard.release();
+        return cur;
+    }
+}
+
+// ****************************************************************************
+// *                   shifting elements inside a buffer                      *
+// ****************************************************************************
+
+// helpers shared by vector, fixed_capacity_vector and
+// small_size_optimized_vector, trivially relocatable elements are moved by
+// memmove instead of one move assignment per element
+//  - elements are constructed and destroyed through c, vector passes its
+//    allocator
+
+namespace detail {
+
+// insert value at pos by shifting [pos, last) one to the right, the storage
+// at last must be uninitialized
+template <class T, class Construct = plain_construct>
+constexpr auto insert_one(T *pos, T *last, T &&value, const Construct &c = {})
+    -> void {
+    if (relocatable_bitwise<T>() && std::is_nothrow_move_constructible_v<T>) {
+        std::memmove(static_cast<void *>(pos + 1),
+                     static_cast<const void *>(pos),
+                     static_cast<std::size_t>(last - pos) * sizeof(T));
+        c.construct(pos, std::move(value));
+        return;
+    }
+    if (pos == last) {
+        c.construct(last, std::move(value));
+        return;
+    }
+    c.construct(last, std::move(*(last - 1)));
+    std::move_backward(pos, last - 1, last);
+    *pos = std::move(value);
+}
+
+// erase [first, last) from [first, end), returns the new end
+template <class T, class Construct = plain_construct>
+constexpr auto erase_range(T *first, T *last, T *end, const Construct &c = {})
+    -> T * {
+    if (first == last)
+        return end;
+    if (relocatable_bitwise<T>()) {
+        destroy_range(first, last, c);
+        std::memmove(static_cast<void *>(first),
+                     static_cast<const void *>(last),
+                     static_cast<std::size_t>(end - last) * sizeof(T));
+        return first + (end - last);
+    }
+    auto new_end = std::move(last, end, first);
+    destroy_range(new_end, end, c);
+    return new_end;
+}
+
+// erase pos from [first, last) by moving the last element into it, returns
+// the new end
+template <class T, class Construct = plain_construct>
+constexpr auto unordered_erase(T *pos, T *last, const Construct &c = {})
+    -> T * {
+    --last;
+    if (pos != last) {
+        if (relocatable_bitwise<T>()) {
+            c.destroy(pos);
+            std::memcpy(static_cast<void *>(pos),
+                        static_cast<const void *>(last), sizeof(T));
+            return last;
+        }
+        *pos = std::move(*last);
+    }
+    c.destroy(last);
+    return last;
+}
+
+// erase the elements of [first, first + sz) satisfying pred, sz is updated
+// even if pred throws, returns the number of erased elements
+template <class T, class Size, class Pred, class Construct = plain_construct>
+constexpr auto erase_if(T *first, Size &sz, Pred &pred,
+                        const Construct &c = {}) -> Size {
+    auto last = first + sz;
+    auto old_sz = sz;
+    if (!relocatable_bitwise<T>()) {
+        auto new_end = std::remove_if(first, last, std::ref(pred));
+        destroy_range(new_end, last, c);
+        sz = static_cast<Size>(new_end - first);
+        return old_sz - sz;
+    }
+
+    // kept elements are relocated down, the guard moves the unvisited tail
+    // down to close the gap when done or when pred throws
+    struct close_gap {
+        T *first;
+        T *&write;
+        T *&read;
+        T *last;
+        Size &sz;
+        ~close_gap() {
+            std::memmove(static_cast<void *>(write),
+                         static_cast<const void *>(read),
+                         static_cast<std::size_t>(last - read) * sizeof(T));
+            sz = static_cast<Size>(write - first + (last - read));
+        }
+    };
+
+    auto write = std::find_if(first, last, std::ref(pred));
+    if (write == last)
+        return 0;
+    auto read = write;
+    {
+        close_gap guard{first, write, read, last, sz};
+        c.destroy(read++);
+        for (; read != last; ++read) {
+            if (pred(*read)) {
+                c.destroy(read);
+            } else {
+                std::memcpy(static_cast<void *>(write),
+                            static_cast<const void *>(read), sizeof(T));
+                ++write;
+            }
+        }
+    }
+    return old_sz - sz;
+}
+
+} // namespace detail
+
+} // namespace mystd
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <concepts>
+#include <type_traits>
+#include <utility>
+
+namespace mystd {
+
+// ****************************************************************************
+// *                               scope_exit                                 *
+// ****************************************************************************
+
+// runs the exit function when leaving the scope, unless released
+//  - used as a rollback guard: `release()` once the work has succeeded
+//  - the exit function must not throw, it may run during stack unwinding
+template <std::invocable EF> class scope_exit {
+  public:
+    // constructors
+    template <class F>
+        requires std::constructible_from<EF, F>
+    constexpr explicit scope_exit(F &&f) noexcept(
+        std::is_nothrow_constructible_v<EF, F>)
+        : _exit_function(std::forward<F>(f)) {}
+
+    scope_exit(const scope_exit &) = delete;
+    auto operator=(const scope_exit &) -> scope_exit & = delete;
+
+    // destructor
+    constexpr ~scope_exit() {
+        if (_active)
+            _exit_function();
+    }
+
+    // modifiers
+    constexpr auto release() noexcept -> void { _active = false; }
+
+  private:
+    [[no_unique_address]] EF _exit_function;
+    bool _active = true;
+};
+
+template <class EF> scope_exit(EF) -> scope_exit<EF>;
+
+} // namespace mystd
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "fixed_capacity_vector.hpp"
+#include "relocate.hpp"
+#include "scope.hpp"
 #include <algorithm>
 #include <cstddef>
+#include <iterator>
 #include <memory>
 #include <type_traits>
 #include <utility>
@@ -18,36 +21,46 @@ template <class T, std::size_t N> class small_size_optimized_vector {
     using const_reference = const value_type &;
     using iterator = T *;
     using const_iterator = const T *;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // the heap pointer lives in the inline buffer bytes rather than pointing
+    // into *this, so relocatable iff its elements are
+    using trivially_relocatable =
+        std::bool_constant<is_trivially_relocatable_v<T>>;
 
     // constructors
-    constexpr small_size_optimized_vector() noexcept
-        : _data(storage_begin()), _sz(0), _cap(N) {}
+    constexpr small_size_optimized_vector() noexcept : _sz_and_flag(0) {}
 
     // copy ctor
     // will not copy capacity, the capacity will be max(other.size, N)
+    // delegates to the default constructor, so the destructor cleans up if an
+    // element copy throws
     constexpr small_size_optimized_vector(
         const small_size_optimized_vector &other)
-        : _data(other._sz > N ? _alloc.allocate(other._sz) : storage_begin()),
-          _sz(other._sz), _cap(std::max(N, other._sz)) {
-        // copy elements
-        for (size_type i = 0; i < _sz; i++)
-            std::construct_at(_data + i, *(other._data + i));
+        : small_size_optimized_vector() {
+        copy_from(other);
     }
 
+    // elements in the buffer are moved, which may throw unless T is
+    // trivially relocatable or nothrow move constructible
+    //  - delegates to the default constructor, so the destructor cleans up if
+    //    an element move throws
     constexpr small_size_optimized_vector(
-        small_size_optimized_vector &&other) noexcept {
-        if (other._cap == N) {
-            // move elements if in buffer
-            _data = storage_begin();
-            for (size_type i = 0; i < other._sz; i++)
-                std::construct_at(_data + i, std::move(*(other._data + i)));
-            other.destroy_all();
+        small_size_optimized_vector &&other) noexcept(
+        is_trivially_relocatable_v<T> ||
+        std::is_nothrow_move_constructible_v<T>)
+        : small_size_optimized_vector() {
+        if (!other.is_heap()) {
+            // relocate elements if in buffer, a single memcpy for trivially
+            // relocatable T
+            relocate_buffer_from(other);
         } else {
             // just move pointer to heap memory
-            _data = std::exchange(other._data, other.storage_begin());
-            _cap = std::exchange(other._cap, N);
+            set_heap(other._rep.heap.data, other._rep.heap.cap);
+            set_size(other.size());
         }
-        _sz = std::exchange(other._sz, 0);
+        other.reset_to_buffer();
     }
 
     // assignment, requires { T does not contain data member type
@@ -56,39 +69,29 @@ template <class T, std::size_t N> class small_size_optimized_vector {
         -> small_size_optimized_vector & {
         if (this == &other)
             return *this;
-        destroy_all();
-        if (_cap < other._sz) {
-            // need heap allocation
-            do_deallocate();
-            _data = _alloc.allocate(other._sz);
-            _cap = other._sz;
-        }
-
-        // copy elements
-        for (size_type i = 0; i < other._sz; i++)
-            std::construct_at(_data + i, *(other._data + i));
-        _sz = other._sz;
+        clear();
+        copy_from(other);
         return *this;
     }
 
-    constexpr auto operator=(small_size_optimized_vector &&other) noexcept
+    constexpr auto operator=(small_size_optimized_vector &&other) noexcept(
+        is_trivially_relocatable_v<T> ||
+        std::is_nothrow_move_constructible_v<T>)
         -> small_size_optimized_vector & {
         if (this == &other)
             return *this;
-        destroy_all();
-        if (other._cap == N) {
-            // move elements if in buffer
-            // since this->cap >= other._cap, no reallocation is needed
-            for (size_type i = 0; i < other._sz; i++)
-                std::construct_at(_data + i, std::move(*(other._data + i)));
-            other.destroy_all();
+        clear();
+        if (!other.is_heap()) {
+            // relocate elements if in buffer
+            // since this->cap >= N, no reallocation is needed
+            relocate_buffer_from(other);
         } else {
             // just move pointer to heap memory
             do_deallocate();
-            _data = std::exchange(other._data, other.storage_begin());
-            _cap = std::exchange(other._cap, N);
+            set_heap(other._rep.heap.data, other._rep.heap.cap);
+            set_size(other.size());
         }
-        _sz = std::exchange(other._sz, 0);
+        other.reset_to_buffer();
         return *this;
     }
 
@@ -99,87 +102,349 @@ template <class T, std::size_t N> class small_size_optimized_vector {
     }
 
     // element access
-    constexpr auto data() const noexcept -> T * { return _data; }
+    // the data pointer is computed from the heap flag rather than stored
+    constexpr auto data() noexcept -> T * {
+        return is_heap() ? _rep.heap.data : buffer_begin();
+    }
+    constexpr auto data() const noexcept -> const T * {
+        return is_heap() ? _rep.heap.data : buffer_begin();
+    }
+
+    constexpr auto begin() noexcept -> iterator { return data(); }
+    constexpr auto begin() const noexcept -> const_iterator { return data(); }
+    constexpr auto end() noexcept -> iterator { return data() + size(); }
+    constexpr auto end() const noexcept -> const_iterator {
+        return data() + size();
+    }
+
+    constexpr auto cbegin() const noexcept -> const_iterator { return begin(); }
+    constexpr auto cend() const noexcept -> const_iterator { return end(); }
+    constexpr auto rbegin() noexcept -> reverse_iterator {
+        return reverse_iterator(end());
+    }
+    constexpr auto rbegin() const noexcept -> const_reverse_iterator {
+        return const_reverse_iterator(end());
+    }
+    constexpr auto rend() noexcept -> reverse_iterator {
+        return reverse_iterator(begin());
+    }
+    constexpr auto rend() const noexcept -> const_reverse_iterator {
+        return const_reverse_iterator(begin());
+    }
+    constexpr auto crbegin() const noexcept -> const_reverse_iterator {
+        return rbegin();
+    }
+    constexpr auto crend() const noexcept -> const_reverse_iterator {
+        return rend();
+    }
 
     constexpr auto operator[](size_type i) noexcept -> reference {
-        return *(_data + i);
+        return *(data() + i);
     }
     constexpr auto operator[](size_type i) const noexcept -> const_reference {
-        return *(_data + i);
+        return *(data() + i);
     }
 
     // capacity
-    constexpr auto empty() const noexcept -> bool { return _sz == 0; }
-    constexpr auto size() const noexcept -> size_type { return _sz; }
-    constexpr auto capacity() const noexcept -> size_type { return _cap; }
+    constexpr auto empty() const noexcept -> bool { return size() == 0; }
+    constexpr auto size() const noexcept -> size_type {
+        return _sz_and_flag >> 1;
+    }
+    constexpr auto capacity() const noexcept -> size_type {
+        return is_heap() ? _rep.heap.cap : N;
+    }
     constexpr auto reserve(size_type new_cap) -> void {
-        if (new_cap > _cap)
+        if (new_cap > capacity())
             grow(new_cap);
     }
 
     // modifiers
     constexpr auto clear() noexcept -> void {
         destroy_all();
-        _sz = 0;
+        set_size(0);
     }
 
-    constexpr auto swap(small_size_optimized_vector &other) noexcept -> void {
-        std::swap(*this, other);
+    // O(1) unless both vectors are in their buffers and T is not trivially
+    // relocatable, then only the elements in the buffers are swapped
+    //  - those elements are swapped and moved, which may throw
+    constexpr auto swap(small_size_optimized_vector &other) noexcept(
+        std::is_nothrow_move_constructible_v<T> &&
+        std::is_nothrow_swappable_v<T>) -> void {
+        if (this == &other)
+            return;
+        if (detail::relocatable_bitwise<T>() ||
+            (is_heap() && other.is_heap())) {
+            // exchange heap pointers, or the buffer bytes of trivially
+            // relocatable elements, no element is touched
+            std::swap(_rep, other._rep);
+            std::swap(_sz_and_flag, other._sz_and_flag);
+        } else if (is_heap()) {
+            swap_heap_with_buffer(other);
+        } else if (other.is_heap()) {
+            other.swap_heap_with_buffer(*this);
+        } else {
+            swap_buffers(other);
+        }
+    }
+
+    friend constexpr auto swap(small_size_optimized_vector &lhs,
+                               small_size_optimized_vector &rhs) noexcept(
+        noexcept(lhs.swap(rhs))) -> void {
+        lhs.swap(rhs);
     }
 
     template <class... Args>
     constexpr auto emplace_back(Args &&...args) -> reference {
-        if (_sz == _cap)
-            grow(_cap * 2);
-        return *std::construct_at(_data + _sz++, std::forward<Args>(args)...);
+        auto sz = size();
+        if (sz == capacity())
+            grow(capacity() * 2);
+        auto p = std::construct_at(data() + sz, std::forward<Args>(args)...);
+        set_size(sz + 1);
+        return *p;
     }
 
     constexpr auto pop_back() noexcept -> void {
-        std::destroy_at(_data + (--_sz));
+        auto sz = size() - 1;
+        set_size(sz);
+        std::destroy_at(data() + sz);
+    }
+
+    template <class... Args>
+    constexpr auto emplace(const_iterator pos, Args &&...args) -> iterator {
+        auto idx = static_cast<size_type>(pos - data());
+        auto sz = size();
+        if (idx == sz) {
+            emplace_back(std::forward<Args>(args)...);
+            return data() + idx;
+        }
+        // args may refer to an element of this container, construct it first
+        T value(std::forward<Args>(args)...);
+        if (sz == capacity())
+            grow(capacity() * 2);
+        detail::insert_one(data() + idx, data() + sz, std::move(value));
+        set_size(sz + 1);
+        return data() + idx;
+    }
+
+    constexpr auto insert(const_iterator pos, const T &value) -> iterator {
+        return emplace(pos, value);
+    }
+
+    constexpr auto insert(const_iterator pos, T &&value) -> iterator {
+        return emplace(pos, std::move(value));
+    }
+
+    constexpr auto erase(const_iterator pos) -> iterator {
+        return erase(pos, pos + 1);
+    }
+
+    constexpr auto erase(const_iterator first, const_iterator last)
+        -> iterator {
+        auto d = data();
+        auto p = d + (first - d);
+        auto new_end = detail::erase_range(p, d + (last - d), d + size());
+        set_size(static_cast<size_type>(new_end - d));
+        return p;
+    }
+
+    // O(1) but does not keep the order: the last element is moved into pos
+    constexpr auto unordered_erase(const_iterator pos) -> iterator {
+        auto d = data();
+        auto p = d + (pos - d);
+        auto new_end = detail::unordered_erase(p, d + size());
+        set_size(static_cast<size_type>(new_end - d));
+        return p;
+    }
+
+    template <class Pred>
+    friend constexpr auto erase_if(small_size_optimized_vector &c, Pred pred)
+        -> size_type {
+        // the size shares its word with the heap flag, so erase through a
+        // copy and write it back, also when pred throws
+        auto sz = c.size();
+        scope_exit write_back{[&] { c.set_size(sz); }};
+        return detail::erase_if(c.data(), sz, pred);
+    }
+
+    template <class U>
+    friend constexpr auto erase(small_size_optimized_vector &c, const U &value)
+        -> size_type {
+        return erase_if(c, [&value](const T &elem) { return elem == value; });
     }
 
   private:
     using storage_type = std::conditional_t<detail::sufficiently_trivial<T>,
                                             T[N], char[N * sizeof(T)]>;
-    T *_data;
-    size_type _sz;
-    size_type _cap;
+
+    struct heap_rep {
+        T *data;
+        size_type cap;
+    };
+
+    // wrapped so the whole buffer can be made the active union member in
+    // constant evaluation
+    struct buffer_rep {
+        alignas(T) storage_type storage;
+    };
+
+    // the inline buffer and the heap pointer/capacity share the same bytes
+    // (like libc++ `std::string`), so `sizeof` is
+    // `max(sizeof(T) * N, 2 * sizeof(void *)) + sizeof(size_type)`
+    union rep {
+        buffer_rep buffer;
+        heap_rep heap;
+
+        // at runtime the buffer is left uninitialized
+        constexpr rep() noexcept {
+            if (std::is_constant_evaluated())
+                std::construct_at(&buffer);
+        }
+    };
+
+    rep _rep;
+    // size() << 1 | is_heap()
+    size_type _sz_and_flag;
     [[no_unique_address]] std::allocator<T> _alloc;
-    [[no_unique_address]] alignas(T) storage_type _storage;
 
-    constexpr auto storage_begin() noexcept -> T * {
+    constexpr auto is_heap() const noexcept -> bool { return _sz_and_flag & 1; }
+
+    constexpr auto set_size(size_type sz) noexcept -> void {
+        _sz_and_flag = sz << 1 | (_sz_and_flag & 1);
+    }
+
+    constexpr auto set_heap(T *data, size_type cap) noexcept -> void {
+        std::construct_at(&_rep.heap, heap_rep{data, cap});
+        _sz_and_flag |= 1;
+    }
+
+    // *this must hold no elements and no heap memory
+    constexpr auto reset_to_buffer() noexcept -> void {
+        if (std::is_constant_evaluated())
+            std::construct_at(&_rep.buffer);
+        _sz_and_flag = 0;
+    }
+
+    constexpr auto buffer_begin() noexcept -> T * {
+        if constexpr (detail::sufficiently_trivial<T>) {
+            return _rep.buffer.storage;
+        } else {
+            return reinterpret_cast<T *>(_rep.buffer.storage);
+        }
+    }
+
+    constexpr auto buffer_begin() const noexcept -> const T * {
         if constexpr (detail::sufficiently_trivial<T>) {
-            return _storage;
+            return _rep.buffer.storage;
         } else {
-            return reinterpret_cast<T *>(_storage);
+            return reinterpret_cast<const T *>(_rep.buffer.storage);
         }
     }
 
     constexpr auto do_deallocate() -> void {
-        if (_cap > N)
-            _alloc.deallocate(_data, _cap);
+        if (is_heap())
+            _alloc.deallocate(_rep.heap.data, _rep.heap.cap);
+    }
+
+    // *this must be empty
+    constexpr auto copy_from(const small_size_optimized_vector &other)
+        -> void {
+        auto sz = other.size();
+        if (sz > capacity()) {
+            // switch back to the buffer first, so *this stays valid if the
+            // allocation throws
+            do_deallocate();
+            reset_to_buffer();
+            set_heap(_alloc.allocate(sz), sz);
+        }
+        // copy elements
+        auto src = other.data();
+        auto dst = data();
+        for (size_type i = 0; i < sz; i++) {
+            std::construct_at(dst + i, src[i]);
+            set_size(i + 1);
+        }
+    }
+
+    // other is in its buffer and *this is empty: other's elements are
+    // relocated to data(), other is left empty in its buffer
+    //  - if an element move throws, *this keeps the elements moved so far and
+    //    other keeps all of its elements
+    constexpr auto relocate_buffer_from(small_size_optimized_vector &other)
+        noexcept(is_trivially_relocatable_v<T> ||
+                 std::is_nothrow_move_constructible_v<T>) -> void {
+        auto sz = other.size();
+        if constexpr (!std::is_nothrow_move_constructible_v<T>) {
+            if (!detail::relocatable_bitwise<T>()) {
+                auto src = other.data();
+                auto dst = data();
+                for (size_type i = 0; i < sz; i++) {
+                    std::construct_at(dst + i, std::move(src[i]));
+                    set_size(i + 1);
+                }
+                other.clear();
+                return;
+            }
+        }
+        uninitialized_relocate(other.data(), other.data() + sz, data());
+        set_size(sz);
+    }
+
+    // *this is on the heap and other is in its buffer: other's elements are
+    // relocated into the buffer of *this, and other takes the heap memory
+    constexpr auto swap_heap_with_buffer(small_size_optimized_vector &other)
+        -> void {
+        auto heap = _rep.heap;
+        auto sz = size();
+        auto other_sz = other.size();
+        reset_to_buffer();
+        uninitialized_relocate(other.data(), other.data() + other_sz,
+                               buffer_begin());
+        set_size(other_sz);
+        other.set_heap(heap.data, heap.cap);
+        other.set_size(sz);
+    }
+
+    // both in their buffers: swap the common prefix, then relocate the rest of
+    // the longer one
+    constexpr auto swap_buffers(small_size_optimized_vector &other) -> void {
+        auto &shorter = size() < other.size() ? *this : other;
+        auto &longer = size() < other.size() ? other : *this;
+        auto n = shorter.size();
+        auto m = longer.size();
+        std::swap_ranges(shorter.data(), shorter.data() + n, longer.data());
+        uninitialized_relocate(longer.data() + n, longer.data() + m,
+                               shorter.data() + n);
+        shorter.set_size(m);
+        longer.set_size(n);
     }
 
     // input n should be greater than capacity
     constexpr auto grow(size_type n) -> void {
         auto new_data = _alloc.allocate(n);
+        auto first = data();
+        auto last = first + size();
 
-        for (size_type i = 0; i < _sz; i++)
-            std::construct_at(new_data + i,
-                              std::move_if_noexcept(*(_data + i)));
-        destroy_all();
+        if (detail::relocatable_bitwise<T>()) {
+            // a single memcpy, old elements need no destruction
+            uninitialized_relocate(first, last, new_data);
+        } else if constexpr (std::is_nothrow_move_constructible_v<T>) {
+            uninitialized_move_if_noexcept(first, last, new_data);
+            destroy_all();
+        } else {
+            // if an element copy throws, free the new storage and leave *this
+            // untouched
+            scope_exit guard{[&] { _alloc.deallocate(new_data, n); }};
+            uninitialized_move_if_noexcept(first, last, new_data);
+            guard.release();
+            destroy_all();
+        }
         do_deallocate();
-
-        _data = new_data;
-        _cap = n;
+        set_heap(new_data, n);
     }
 
-    constexpr auto destroy_all() const noexcept -> void {
+    constexpr auto destroy_all() noexcept -> void {
         if constexpr (!std::is_trivially_destructible_v<T>) {
-            for (auto first = _data, last = _data + _sz; first != last;
-                 first++) {
-                std::destroy_at(first);
-            }
+            std::destroy(data(), data() + size());
         }
     }
 };
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "shared_ptr.hpp"
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+namespace mystd {
+
+// ****************************************************************************
+// *                           atomic_shared_ptr                              *
+// ****************************************************************************
+
+// a shared_ptr that can be loaded and replaced concurrently, with split
+// reference counts
+//  - the stored shared_ptr lives in a holder, a control block that owns a
+//    `shared_ptr<T>`, one word holds the holder pointer in its low 48 bits
+//    and a local count in its high 16 bits
+//  - `load` borrows the holder by incrementing the local count of the word,
+//    copies the stored shared_ptr, then gives the borrow back by decrementing
+//    the local count, or, if the holder has been replaced meanwhile, its
+//    shared count
+//  - a null shared_ptr is stored as no holder, which is never borrowed
+//  - a writer swaps the word and moves the local count of the old holder into
+//    its shared count, so the holder stays alive until every borrow is given
+//    back, readers never wait for writers and writers never wait for readers
+//  - the reference of the atomic_shared_ptr itself counts as `bias` in the
+//    shared count of its holder, so that borrows given back between the swap
+//    and the move of the local count cannot take it to zero
+//  - `store`, `exchange` and `compare_exchange` allocate a holder, so reads
+//    are cheap and writes cost one allocation, fit for read-mostly snapshots
+//  - loads acquire the stored value and writes release it
+//  - at most 65535 loads may be in progress at a time
+template <class T> class atomic_shared_ptr {
+    using holder = detail::control_block_with_obj<shared_ptr<T>>;
+
+  public:
+    using value_type = shared_ptr<T>;
+
+    static constexpr bool is_always_lock_free =
+        std::atomic<std::uintptr_t>::is_always_lock_free;
+
+    // constructors
+    constexpr atomic_shared_ptr() noexcept = default;
+    constexpr atomic_shared_ptr(std::nullptr_t) noexcept {}
+    atomic_shared_ptr(shared_ptr<T> desired)
+        : _word{pack(make_holder(std::move(desired)))} {}
+
+    atomic_shared_ptr(const atomic_shared_ptr &) = delete;
+    auto operator=(const atomic_shared_ptr &) -> atomic_shared_ptr & = delete;
+
+    // destructor
+    ~atomic_shared_ptr() {
+        // no load can be in progress
+        retire(_word.load(std::memory_order_relaxed));
+    }
+
+    // operations
+    auto is_lock_free() const noexcept -> bool {
+        return _word.is_lock_free();
+    }
+
+    auto load() const -> shared_ptr<T> {
+        auto h = borrow();
+        shared_ptr<T> sp = h ? *h->get() : shared_ptr<T>{};
+        give_back(h);
+        return sp;
+    }
+
+    operator shared_ptr<T>() const { return load(); }
+
+    auto store(shared_ptr<T> desired) -> void {
+        retire(_word.exchange(pack(make_holder(std::move(desired))),
+                              std::memory_order_acq_rel));
+    }
+
+    auto operator=(shared_ptr<T> desired) -> atomic_shared_ptr & {
+        store(std::move(desired));
+        return *this;
+    }
+
+    auto operator=(std::nullptr_t) noexcept -> atomic_shared_ptr & {
+        retire(_word.exchange(0, std::memory_order_acq_rel));
+        return *this;
+    }
+
+    auto exchange(shared_ptr<T> desired) -> shared_ptr<T> {
+        auto old = _word.exchange(pack(make_holder(std::move(desired))),
+                                  std::memory_order_acq_rel);
+        // other loads may still be copying it, so the old value is copied
+        shared_ptr<T> sp = holder_of(old) ? *holder_of(old)->get()
+                                          : shared_ptr<T>{};
+        retire(old);
+        return sp;
+    }
+
+    // replaces the stored value with desired if it is equivalent to expected
+    // (same pointer and same control block), otherwise loads it into
+    // expected
+    auto compare_exchange_strong(shared_ptr<T> &expected,
+                                 shared_ptr<T> desired) -> bool {
+        holder *replacement = nullptr;
+        bool made = false;
+        while (true) {
+            auto h = borrow();
+            const shared_ptr<T> &current = h ? *h->get() : null_value();
+            if (current != expected || !current.owner_equal(expected)) {
+                expected = current;
+                give_back(h);
+                retire(pack(replacement));
+                return false;
+            }
+            if (!made) {
+                // allocated without a borrow held, then compared again
+                give_back(h);
+                replacement = make_holder(std::move(desired));
+                made = true;
+                continue;
+            }
+
+            auto word = _word.load(std::memory_order_relaxed);
+            while (holder_of(word) == h) {
+                if (_word.compare_exchange_weak(word, pack(replacement),
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+                    retire(word);
+                    give_back(h);
+                    return true;
+                }
+            }
+            // replaced meanwhile, compare again
+            give_back(h);
+        }
+    }
+
+    auto compare_exchange_weak(shared_ptr<T> &expected, shared_ptr<T> desired)
+        -> bool {
+        return compare_exchange_strong(expected, std::move(desired));
+    }
+
+  private:
+    static_assert(sizeof(std::uintptr_t) == 8,
+                  "the holder pointer and the local count share 64 bits");
+
+    static constexpr int pointer_bits = 48;
+    static constexpr std::uintptr_t one = std::uintptr_t{1} << pointer_bits;
+    static constexpr std::uintptr_t pointer_mask = one - 1;
+    // more than the local count can hold
+    static constexpr std::size_t bias = std::size_t{1} << (64 - pointer_bits);
+
+    // a null shared_ptr is stored as no holder at all
+    static auto make_holder(shared_ptr<T> &&desired) -> holder * {
+        if (!desired)
+            return nullptr;
+        auto h = detail::allocate_block<holder>(std::allocator<holder>{});
+        h->emplace(std::move(desired));
+        // not shared yet
+        h->shared_count.store(bias, std::memory_order_relaxed);
+        return h;
+    }
+
+    static auto pack(holder *h) noexcept -> std::uintptr_t {
+        auto bits = reinterpret_cast<std::uintptr_t>(h);
+        assert((bits & ~pointer_mask) == 0 && "pointer wider than 48 bits");
+        return bits;
+    }
+
+    static auto holder_of(std::uintptr_t word) noexcept -> holder * {
+        return reinterpret_cast<holder *>(word & pointer_mask);
+    }
+
+    static auto local_count(std::uintptr_t word) noexcept -> std::size_t {
+        return word >> pointer_bits;
+    }
+
+    static auto null_value() noexcept -> const shared_ptr<T> & {
+        static const shared_ptr<T> null;
+        return null;
+    }
+
+    // the holder stays alive until it is given back
+    //  - not a fetch_add: a borrow of null could be dropped by a writer and
+    //    taken back from a later null word
+    auto borrow() const noexcept -> holder * {
+        auto word = _word.load(std::memory_order_relaxed);
+        do {
+            if (holder_of(word) == nullptr)
+                return nullptr;
+        } while (!_word.compare_exchange_weak(word, word + one,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_relaxed));
+        return holder_of(word);
+    }
+
+    auto give_back(holder *h) const noexcept -> void {
+        if (h == nullptr)
+            return;
+        auto word = _word.load(std::memory_order_relaxed);
+        while (holder_of(word) == h) {
+            if (_word.compare_exchange_weak(word, word - one,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed))
+                return;
+        }
+        // the writer that replaced h moved our borrow into its shared count
+        h->decrement_shared();
+    }
+
+    // takes over a word that has been swapped out
+    static auto retire(std::uintptr_t word) noexcept -> void {
+        auto h = holder_of(word);
+        if (h == nullptr)
+            return;
+        // the reference of this atomic_shared_ptr goes away, one reference
+        // per borrow comes in, in one step: borrows given back before it
+        // only take the count from bias towards bias - borrows
+        auto drop = bias - local_count(word);
+        if (h->shared_count.fetch_sub(drop, std::memory_order_acq_rel) == drop)
+            h->release_shared();
+    }
+
+    mutable std::atomic<std::uintptr_t> _word{0};
+};
+
+} // namespace mystd
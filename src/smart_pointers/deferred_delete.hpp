@@ -0,0 +1,187 @@
+#pragma once
+
+#include "unique_ptr.hpp"
+#include <atomic>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace mystd {
+
+// ****************************************************************************
+// *                                reclaimer                                 *
+// ****************************************************************************
+
+// destroys retired objects on a background thread, so that the thread that
+// drops the last reference to a big object does not run its destructor
+//  - retiring allocates a node and pushes it onto a lock-free stack, only a
+//    push onto an empty stack wakes the reclaimer thread
+//  - the reclaimer thread takes the whole stack at once and destroys the
+//    batch in retire order
+//  - no epochs or hazard pointers: an object is retired by its last owner,
+//    when nobody can read it anymore, the deferral is only about who pays
+//    for the destructor
+//  - the destructor of a reclaimer destroys what is left and joins its
+//    thread, nothing may be retired to it meanwhile
+class reclaimer {
+  public:
+    reclaimer() : _thread{[this] { run(); }} {}
+
+    reclaimer(const reclaimer &) = delete;
+    auto operator=(const reclaimer &) -> reclaimer & = delete;
+
+    ~reclaimer() {
+        // the last node to be reclaimed stops the thread
+        stop_node stop{{nullptr, &stop_node::reclaim}, this};
+        push(&stop);
+        _thread.join();
+    }
+
+    // the process-wide reclaimer, started on first use
+    //  - joined during static destruction, objects may not be retired to it
+    //    afterwards
+    static auto instance() -> reclaimer & {
+        static reclaimer r;
+        return r;
+    }
+
+    // hands p over to the reclaimer thread, which calls `d(p)`
+    //  - if the node cannot be allocated, `d(p)` is called right away
+    template <class T, class Deleter = default_delete<T>>
+    auto retire(T *p, Deleter d = {}) noexcept -> void {
+        // d is not moved from if the allocation fails
+        auto n = new (std::nothrow) retired_node<T, Deleter>{
+            {nullptr, &retired_node<T, Deleter>::reclaim}, p, std::move(d)};
+        if (n == nullptr) {
+            d(p);
+            return;
+        }
+        push(n);
+    }
+
+    // waits until everything retired before the call has been destroyed
+    //  - the marker may be gone as soon as its flag is set, so the reclaimer
+    //    thread wakes drain through `_drained`, which outlives both
+    auto drain() noexcept -> void {
+        marker_node marker{{nullptr, &marker_node::reclaim}, this, {false}};
+        auto seen = _drained.load(std::memory_order_acquire);
+        push(&marker);
+        while (!marker.done.load(std::memory_order_acquire)) {
+            _drained.wait(seen, std::memory_order_acquire);
+            seen = _drained.load(std::memory_order_acquire);
+        }
+    }
+
+  private:
+    // reclaim frees whatever the node holds, and the node if it was
+    // allocated, a node on the stack of another thread may be gone as soon
+    // as it is reclaimed
+    struct node {
+        node *next;
+        void (*reclaim)(node *) noexcept;
+    };
+
+    template <class T, class Deleter> struct retired_node : node {
+        T *ptr;
+        [[no_unique_address]] Deleter deleter;
+
+        static auto reclaim(node *self) noexcept -> void {
+            auto retired = static_cast<retired_node *>(self);
+            retired->deleter(retired->ptr);
+            delete retired;
+        }
+    };
+
+    // pushed by drain, wakes it up
+    struct marker_node : node {
+        reclaimer *owner;
+        std::atomic<bool> done;
+
+        static auto reclaim(node *self) noexcept -> void {
+            auto owner = static_cast<marker_node *>(self)->owner;
+            static_cast<marker_node *>(self)->done.store(
+                true, std::memory_order_release);
+            owner->_drained.fetch_add(1, std::memory_order_release);
+            owner->_drained.notify_all();
+        }
+    };
+
+    // pushed by the destructor, stops the thread
+    struct stop_node : node {
+        reclaimer *owner;
+
+        static auto reclaim(node *self) noexcept -> void {
+            static_cast<stop_node *>(self)->owner->_running = false;
+        }
+    };
+
+    auto push(node *n) noexcept -> void {
+        auto head = _head.load(std::memory_order_relaxed);
+        do {
+            n->next = head;
+        } while (!_head.compare_exchange_weak(head, n,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+        if (head == nullptr)
+            _head.notify_one();
+    }
+
+    auto run() noexcept -> void {
+        while (_running) {
+            _head.wait(nullptr, std::memory_order_acquire);
+            auto batch = _head.exchange(nullptr, std::memory_order_acquire);
+
+            // pushed last first, reversed to be reclaimed in retire order
+            node *in_order = nullptr;
+            while (batch != nullptr) {
+                auto next = batch->next;
+                batch->next = in_order;
+                in_order = std::exchange(batch, next);
+            }
+            while (in_order != nullptr) {
+                auto next = in_order->next;
+                in_order->reclaim(in_order);
+                in_order = next;
+            }
+        }
+    }
+
+    std::atomic<node *> _head{nullptr};
+    std::atomic<unsigned> _drained{0}; // markers reclaimed so far
+    bool _running = true; // only touched by the reclaimer thread
+    std::thread _thread;
+};
+
+// ****************************************************************************
+// *                             deferred_delete                              *
+// ****************************************************************************
+
+// a deleter that retires the object to a reclaimer, where Deleter destroys
+// it on the reclaimer thread
+//  - e.g. `shared_ptr<T>(new T, deferred_delete<T>{})`, the last owner only
+//    pays for a node allocation and a push, or
+//    `unique_ptr<T, deferred_delete<T>>`
+//  - `reclaimer::instance()` unless another reclaimer is given
+template <class T, class Deleter = default_delete<T>> class deferred_delete {
+  public:
+    using pointer = std::remove_extent_t<T> *;
+
+    constexpr deferred_delete() noexcept = default;
+    explicit deferred_delete(reclaimer &r, Deleter d = {}) noexcept
+        : _reclaimer{&r}, _deleter{std::move(d)} {}
+
+    auto operator()(pointer p) const noexcept -> void {
+        // unique_ptr calls its deleter even when it is empty
+        if (p == nullptr)
+            return;
+        auto &r = _reclaimer != nullptr ? *_reclaimer : reclaimer::instance();
+        r.retire(p, _deleter);
+    }
+
+  private:
+    reclaimer *_reclaimer = nullptr;
+    [[no_unique_address]] Deleter _deleter{};
+};
+
+} // namespace mystd
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "ref_count.hpp"
+#include "unique_ptr.hpp"
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace mystd {
+
+// ****************************************************************************
+// *                              intrusive_ptr                               *
+// ****************************************************************************
+
+// a pointer to an object that counts its own references
+//  - one pointer wide, no control block
+//  - the count is managed through `intrusive_ptr_add_ref(p)` and
+//    `intrusive_ptr_release(p)`, found by ADL, as in boost
+//  - since the count is in the object, an intrusive_ptr can be made from a
+//    raw pointer at any time, e.g. from `this`
+template <class T> class intrusive_ptr {
+  public:
+    using element_type = T;
+
+    // one raw pointer
+    using trivially_relocatable = std::true_type;
+
+    // constructors
+    constexpr intrusive_ptr() noexcept = default;
+    constexpr intrusive_ptr(std::nullptr_t) noexcept {}
+
+    // add_ref = false takes over a reference that has already been counted,
+    // e.g. one given up by `detach()`
+    explicit intrusive_ptr(T *ptr, bool add_ref = true) noexcept : _ptr{ptr} {
+        if (_ptr != nullptr && add_ref)
+            intrusive_ptr_add_ref(_ptr);
+    }
+
+    intrusive_ptr(const intrusive_ptr &other) noexcept
+        : intrusive_ptr(other._ptr) {}
+    intrusive_ptr(intrusive_ptr &&other) noexcept
+        : _ptr{std::exchange(other._ptr, nullptr)} {}
+
+    template <detail::pointer_convertible_to<T> U>
+    intrusive_ptr(const intrusive_ptr<U> &other) noexcept
+        : intrusive_ptr(other.get()) {}
+
+    template <detail::pointer_convertible_to<T> U>
+    intrusive_ptr(intrusive_ptr<U> &&other) noexcept
+        : _ptr{other.detach()} {}
+
+    // destructor
+    ~intrusive_ptr() {
+        if (_ptr != nullptr)
+            intrusive_ptr_release(_ptr);
+    }
+
+    // assignments
+    auto operator=(const intrusive_ptr &rhs) noexcept -> intrusive_ptr & {
+        intrusive_ptr(rhs).swap(*this);
+        return *this;
+    }
+
+    auto operator=(intrusive_ptr &&rhs) noexcept -> intrusive_ptr & {
+        intrusive_ptr(std::move(rhs)).swap(*this);
+        return *this;
+    }
+
+    template <detail::pointer_convertible_to<T> U>
+    auto operator=(const intrusive_ptr<U> &rhs) noexcept -> intrusive_ptr & {
+        intrusive_ptr(rhs).swap(*this);
+        return *this;
+    }
+
+    template <detail::pointer_convertible_to<T> U>
+    auto operator=(intrusive_ptr<U> &&rhs) noexcept -> intrusive_ptr & {
+        intrusive_ptr(std::move(rhs)).swap(*this);
+        return *this;
+    }
+
+    // modifiers
+    auto reset() noexcept -> void { intrusive_ptr().swap(*this); }
+
+    auto reset(T *ptr, bool add_ref = true) noexcept -> void {
+        intrusive_ptr(ptr, add_ref).swap(*this);
+    }
+
+    // gives up the reference without releasing it
+    [[nodiscard]] auto detach() noexcept -> T * {
+        return std::exchange(_ptr, nullptr);
+    }
+
+    auto swap(intrusive_ptr &other) noexcept -> void {
+        std::swap(_ptr, other._ptr);
+    }
+
+    friend auto swap(intrusive_ptr &lhs, intrusive_ptr &rhs) noexcept -> void {
+        lhs.swap(rhs);
+    }
+
+    // observers
+    auto get() const noexcept -> T * { return _ptr; }
+    auto operator*() const noexcept -> T & { return *_ptr; }
+    auto operator->() const noexcept -> T * { return _ptr; }
+    explicit operator bool() const noexcept { return _ptr != nullptr; }
+
+    // comparison
+    template <class U>
+    [[nodiscard]] auto operator==(const intrusive_ptr<U> &rhs) const noexcept
+        -> bool {
+        return get() == rhs.get();
+    }
+
+    [[nodiscard]] auto operator==(std::nullptr_t) const noexcept -> bool {
+        return get() == nullptr;
+    }
+
+  private:
+    T *_ptr = nullptr;
+};
+
+template <class T, class... Args>
+auto make_intrusive(Args &&...args) -> intrusive_ptr<T> {
+    return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+// ****************************************************************************
+// *                          intrusive_ref_counter                           *
+// ****************************************************************************
+
+// a base that gives Derived a reference count for intrusive_ptr, with one of
+// the policies of ref_count.hpp
+//  - the last release deletes the object as a `Derived`, classes derived
+//    further need a virtual destructor in Derived
+//  - copying an object does not copy its count, like enable_shared_from_this
+//  - with `biased`, the thread that constructs the object owns the count
+template <class Derived, class Policy = multi_threaded>
+class intrusive_ref_counter {
+  public:
+    auto use_count() const noexcept -> std::size_t {
+        auto count = Policy::load(_count);
+        if constexpr (has_owner) {
+            if (_unclaimed.load(std::memory_order_relaxed))
+                count--;
+        }
+        return count;
+    }
+
+    // like shared_from_this, but never throws: any object managed by
+    // intrusive_ptr can make another one
+    auto intrusive_from_this() noexcept -> intrusive_ptr<Derived> {
+        return intrusive_ptr<Derived>(static_cast<Derived *>(this));
+    }
+
+    auto intrusive_from_this() const noexcept
+        -> intrusive_ptr<const Derived> {
+        return intrusive_ptr<const Derived>(static_cast<const Derived *>(this));
+    }
+
+  protected:
+    intrusive_ref_counter() noexcept {
+        if constexpr (has_owner)
+            _unclaimed.store(true, std::memory_order_relaxed);
+        if constexpr (requires { _count.on_zero; }) {
+            // a biased count may find out later that it dropped to zero
+            _count.on_zero = [](void *self) noexcept {
+                destroy(static_cast<const intrusive_ref_counter *>(self));
+            };
+            _count.context = this;
+        }
+    }
+    intrusive_ref_counter(const intrusive_ref_counter &) noexcept
+        : intrusive_ref_counter() {}
+    auto operator=(const intrusive_ref_counter &) noexcept
+        -> intrusive_ref_counter & {
+        return *this;
+    }
+    ~intrusive_ref_counter() = default;
+
+  private:
+    // a biased count only finds out that it dropped to zero through its
+    // owner: a reference taken and dropped by another thread while the
+    // owner's count is 0 moves `shared` from 0 to 1 and back, which looks
+    // like any other reference of another thread
+    //  - the owner's count starts at 1 instead, and the first reference
+    //    taken, by any thread, claims it, a non-owner hands it back through
+    //    the owner's queue as for any reference made by the owner
+    static constexpr bool has_owner =
+        requires(typename Policy::count_type &c) { c.owner; };
+
+    struct _empty {};
+
+    mutable typename Policy::count_type _count{has_owner ? 1 : 0};
+    [[no_unique_address]] mutable std::conditional_t<
+        has_owner, std::atomic<bool>, _empty> _unclaimed;
+
+    static auto destroy(const intrusive_ref_counter *p) noexcept -> void {
+        delete static_cast<const Derived *>(p);
+    }
+
+    friend auto intrusive_ptr_add_ref(const intrusive_ref_counter *p) noexcept
+        -> void {
+        if constexpr (has_owner) {
+            // loaded first, only the first reference pays for an exchange
+            if (p->_unclaimed.load(std::memory_order_relaxed) &&
+                p->_unclaimed.exchange(false, std::memory_order_relaxed))
+                return;
+        }
+        Policy::increment(p->_count);
+    }
+
+    friend auto intrusive_ptr_release(const intrusive_ref_counter *p) noexcept
+        -> void {
+        if (Policy::decrement(p->_count))
+            destroy(p);
+    }
+};
+
+} // namespace mystd
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <utility>
+
+// biased_before_push is called once by a non-owner between queueing a count
+// and pushing it to its owner, biased_in_merge once between taking the
+// owner's count and adding it to the shared one, only for testing the
+// interleavings in between
+//  - compiled in only when MYSTD_INSTRUMENT_BIASED_COUNT is defined
+#ifdef MYSTD_INSTRUMENT_BIASED_COUNT
+inline void (*biased_before_push)() = nullptr;
+inline void (*biased_in_merge)() = nullptr;
+#endif
+
+namespace mystd {
+
+// ****************************************************************************
+// *                         reference count policies                         *
+// ****************************************************************************
+
+// a policy decides how a reference count is stored and updated
+//  - `count_type`: constructible from `std::size_t`
+//  - `load(c)`: the current value, no ordering
+//  - `load_acquire(c)`: the current value, sees everything done before the
+//    decrements that brought it there
+//  - `increment(c)`
+//  - `decrement(c)`: returns whether the count dropped to zero, if so, all
+//    writes made by the owners of the other references are visible
+//  - `increment_if_not_zero(c)`: returns false if the count was zero
+//  - `weak_policy` (optional): the policy of the weak count, the policy
+//    itself if absent
+//  - `count_type::on_zero` and `count_type::context` (optional): a decrement
+//    that returned false may turn out to be the last one later, then
+//    `on_zero(context)` is called
+
+// references may be shared across threads
+struct multi_threaded {
+    using count_type = std::atomic<std::size_t>;
+
+    static auto load(const count_type &c) noexcept -> std::size_t {
+        return c.load(std::memory_order_relaxed);
+    }
+
+    static auto load_acquire(const count_type &c) noexcept -> std::size_t {
+        return c.load(std::memory_order_acquire);
+    }
+
+    // relaxed: a new reference is always copied from an existing one, which
+    // already happens-before the copy
+    static auto increment(count_type &c) noexcept -> void {
+        c.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // only the thread that drops the count to zero needs to acquire
+    static auto decrement(count_type &c) noexcept -> bool {
+        if (c.fetch_sub(1, std::memory_order_release) == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+        return false;
+    }
+
+    // lock-free add-if-not-zero, relaxed since there is nothing to acquire or
+    // release
+    static auto increment_if_not_zero(count_type &c) noexcept -> bool {
+        auto count = c.load(std::memory_order_relaxed);
+        do {
+            if (count == 0)
+                return false;
+        } while (!c.compare_exchange_weak(count, count + 1,
+                                          std::memory_order_relaxed));
+        return true;
+    }
+};
+
+// all references stay in one thread, counts are plain integers
+struct single_threaded {
+    using count_type = std::size_t;
+
+    static auto load(const count_type &c) noexcept -> std::size_t { return c; }
+
+    static auto load_acquire(const count_type &c) noexcept -> std::size_t {
+        return c;
+    }
+
+    static auto increment(count_type &c) noexcept -> void { ++c; }
+
+    static auto decrement(count_type &c) noexcept -> bool { return --c == 0; }
+
+    static auto increment_if_not_zero(count_type &c) noexcept -> bool {
+        if (c == 0)
+            return false;
+        ++c;
+        return true;
+    }
+};
+
+// ****************************************************************************
+// *                          biased reference count                          *
+// ****************************************************************************
+
+// the thread that creates a count (its owner) updates it without atomic
+// read-modify-write, other threads use a separate atomic count
+//  - the total is `biased + shared`, `shared` goes negative when references
+//    made by the owner are dropped by other threads
+//  - the two are merged, after which every thread uses `shared`:
+//      - when the owner drops its last reference
+//      - when another thread would take `shared` below zero, the count is
+//        queued to the owner, which merges it on its next decrement or on
+//        `biased::collect()`, until then the object is kept alive
+//      - by the other thread itself, once the owner thread has exited
+//  - `load` from a non-owner reads the owner's count without synchronization,
+//    `use_count()` and `lock()` from another thread may lag behind it
+//      - `lock()` waits out a merge in progress, which takes the owner's
+//        count before it adds it to `shared`, rather than fail on a live
+//        object
+struct biased {
+    struct count_type;
+
+    // weak references are rarely copied, the weak count stays atomic
+    using weak_policy = multi_threaded;
+
+    static auto load(const count_type &c) noexcept -> std::size_t;
+    static auto load_acquire(const count_type &c) noexcept -> std::size_t;
+    static auto increment(count_type &c) noexcept -> void;
+    static auto decrement(count_type &c) noexcept -> bool;
+    static auto increment_if_not_zero(count_type &c) noexcept -> bool;
+
+    // merges the counts queued to the calling thread, objects whose last
+    // reference was dropped by another thread are destroyed here
+    static auto collect() noexcept -> void;
+
+  private:
+    // `shared` holds `count * 4 + flags`
+    static constexpr std::int64_t merged = 1; // biased is folded in
+    static constexpr std::int64_t queued = 2; // owned by a thread's queue
+    static constexpr std::int64_t one = 4;
+
+    static constexpr auto count_of(std::int64_t word) noexcept
+        -> std::int64_t {
+        return word >> 2;
+    }
+
+    // the queue of a thread, kept alive by the counts it owns so that its
+    // address is not reused by another thread while they compare against it
+    struct thread_record {
+        std::atomic<count_type *> queue{nullptr};
+        std::atomic<std::size_t> refs{1};
+
+        auto retain() noexcept -> void {
+            refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        auto release() noexcept -> void {
+            if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete this;
+        }
+    };
+
+    // trivially destructible, still usable from other thread_local
+    // destructors after the thread has exited
+    struct thread_state {
+        thread_record *record = nullptr;
+        bool exited = false;
+    };
+
+    struct thread_exit {
+        ~thread_exit();
+    };
+
+    static auto this_thread() noexcept -> thread_state & {
+        thread_local constinit thread_state state;
+        return state;
+    }
+
+    // the queue head of an exited thread
+    static auto closed() noexcept -> count_type * {
+        static char tag;
+        return reinterpret_cast<count_type *>(&tag);
+    }
+
+    static auto current_record() noexcept -> thread_record *;
+    static auto owned(const count_type &c) noexcept -> bool;
+    static auto push(count_type &c) noexcept -> bool;
+    static auto drain(count_type *list) noexcept -> void;
+    static auto merge(count_type &c, std::int64_t word_delta) noexcept -> bool;
+};
+
+struct biased::count_type {
+    explicit count_type(std::size_t n) noexcept : owner{current_record()} {
+        if (owner != nullptr) {
+            owner->retain();
+            biased.store(n, std::memory_order_relaxed);
+        } else {
+            // no owner (the thread is exiting or out of memory), starts
+            // merged
+            active = false;
+            shared.store(static_cast<std::int64_t>(n) * one + merged,
+                         std::memory_order_relaxed);
+        }
+    }
+    count_type(const count_type &) = delete;
+    auto operator=(const count_type &) -> count_type & = delete;
+    ~count_type() {
+        if (owner != nullptr)
+            owner->release();
+    }
+
+    thread_record *const owner;
+    std::atomic<std::size_t> biased{0}; // only stored by the owner
+    bool active = true; // not merged, only seen by the owner
+    std::atomic<std::int64_t> shared{0};
+    count_type *next = nullptr; // in the owner's queue
+
+    void (*on_zero)(void *) noexcept = nullptr;
+    void *context = nullptr;
+};
+
+inline auto biased::current_record() noexcept -> thread_record * {
+    auto &state = this_thread();
+    if (state.record == nullptr && !state.exited) {
+        state.record = new (std::nothrow) thread_record;
+        // first use in this thread, registers the destructor
+        if (state.record != nullptr) {
+            thread_local thread_exit on_exit;
+        }
+    }
+    return state.record;
+}
+
+inline biased::thread_exit::~thread_exit() {
+    auto &state = this_thread();
+    auto record = state.record;
+    // from now on this thread is a non-owner of its counts, the ones pushed
+    // after the queue is closed are merged by the thread pushing them
+    state.record = nullptr;
+    state.exited = true;
+    drain(record->queue.exchange(closed(), std::memory_order_acq_rel));
+    record->release();
+}
+
+inline auto biased::owned(const count_type &c) noexcept -> bool {
+    auto record = this_thread().record;
+    return record != nullptr && c.owner == record && c.active;
+}
+
+// fails once the owner has exited
+inline auto biased::push(count_type &c) noexcept -> bool {
+    auto &queue = c.owner->queue;
+    auto head = queue.load(std::memory_order_acquire);
+    do {
+        if (head == closed())
+            return false;
+        c.next = head;
+    } while (!queue.compare_exchange_weak(head, &c, std::memory_order_release,
+                                          std::memory_order_acquire));
+    // c may already be merged and freed by the owner
+    return true;
+}
+
+// called by the owner, or by anyone once the owner has exited
+//  - returns whether the total is zero, `word_delta` also clears the flags
+//    held by the caller
+inline auto biased::merge(count_type &c, std::int64_t word_delta) noexcept
+    -> bool {
+    auto b = static_cast<std::int64_t>(
+        c.biased.exchange(0, std::memory_order_relaxed));
+#ifdef MYSTD_INSTRUMENT_BIASED_COUNT
+    if (auto hook = std::exchange(biased_in_merge, nullptr))
+        hook();
+#endif
+    auto old = c.shared.fetch_add(b * one + merged + word_delta,
+                                  std::memory_order_acq_rel);
+    return count_of(old) + b == 0 && !((old + word_delta) & queued);
+}
+
+inline auto biased::drain(count_type *list) noexcept -> void {
+    while (list != nullptr && list != closed()) {
+        auto &c = *list;
+        list = c.next;
+        bool zero;
+        if (c.active) {
+            c.active = false;
+            zero = merge(c, -queued);
+        } else {
+            // merged by the owner while queued, it left the zero to us
+            zero = count_of(c.shared.fetch_sub(queued,
+                                               std::memory_order_acq_rel)) == 0;
+        }
+        if (zero)
+            c.on_zero(c.context);
+    }
+}
+
+inline auto biased::collect() noexcept -> void {
+    auto record = this_thread().record;
+    if (record != nullptr &&
+        record->queue.load(std::memory_order_relaxed) != nullptr)
+        drain(record->queue.exchange(nullptr, std::memory_order_acquire));
+}
+
+inline auto biased::load(const count_type &c) noexcept -> std::size_t {
+    auto total = static_cast<std::int64_t>(
+                     c.biased.load(std::memory_order_relaxed)) +
+                 count_of(c.shared.load(std::memory_order_relaxed));
+    return total > 0 ? static_cast<std::size_t>(total) : 0;
+}
+
+inline auto biased::load_acquire(const count_type &c) noexcept
+    -> std::size_t {
+    auto total = static_cast<std::int64_t>(
+                     c.biased.load(std::memory_order_acquire)) +
+                 count_of(c.shared.load(std::memory_order_acquire));
+    return total > 0 ? static_cast<std::size_t>(total) : 0;
+}
+
+inline auto biased::increment(count_type &c) noexcept -> void {
+    if (owned(c)) {
+        c.biased.store(c.biased.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+    } else {
+        c.shared.fetch_add(one, std::memory_order_relaxed);
+    }
+}
+
+inline auto biased::decrement(count_type &c) noexcept -> bool {
+    if (owned(c)) {
+        collect();
+        // collect may have merged c
+        if (c.active) {
+            auto b = c.biased.load(std::memory_order_relaxed) - 1;
+            c.biased.store(b, std::memory_order_relaxed);
+            if (b != 0)
+                return false;
+            c.active = false;
+            return merge(c, 0);
+        }
+    }
+
+    auto old = c.shared.fetch_sub(one, std::memory_order_acq_rel);
+    if (old & merged)
+        return count_of(old - one) == 0 && !(old & queued);
+    if (count_of(old - one) >= 0 || (old & queued))
+        return false;
+
+    // a reference counted by the owner was dropped, the total may be zero
+    auto prev = c.shared.fetch_or(queued, std::memory_order_acq_rel);
+    if (prev & queued)
+        return false;
+    if (prev & merged) {
+        // merged in between, nobody else frees while our flag is set
+        return count_of(c.shared.fetch_sub(queued,
+                                           std::memory_order_acq_rel)) == 0;
+    }
+#ifdef MYSTD_INSTRUMENT_BIASED_COUNT
+    if (auto hook = std::exchange(biased_before_push, nullptr))
+        hook();
+#endif
+    if (push(c))
+        return false;
+    // the owner has exited, its count can no longer change, but it may have
+    // merged it before exiting, then only our flag is left to clear
+    if (c.shared.load(std::memory_order_acquire) & merged) {
+        return count_of(c.shared.fetch_sub(queued,
+                                           std::memory_order_acq_rel)) == 0;
+    }
+    return merge(c, -queued);
+}
+
+inline auto biased::increment_if_not_zero(count_type &c) noexcept -> bool {
+    if (owned(c)) {
+        auto b = c.biased.load(std::memory_order_relaxed);
+        // no other thread can merge while the owner is alive
+        if (static_cast<std::int64_t>(b) +
+                count_of(c.shared.load(std::memory_order_acquire)) <=
+            0)
+            return false;
+        c.biased.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    auto word = c.shared.load(std::memory_order_relaxed);
+    for (;;) {
+        auto total = count_of(word);
+        if (!(word & merged)) {
+            auto b = c.biased.load(std::memory_order_relaxed);
+            if (b == 0 && total <= 0) {
+                // the owner's count is only zero in an unmerged word while
+                // it is being merged, `shared` alone would miss it, wait for
+                // the merged word
+                std::this_thread::yield();
+                word = c.shared.load(std::memory_order_relaxed);
+                continue;
+            }
+            total += static_cast<std::int64_t>(b);
+        }
+        // zero is final: the total of an unmerged word only gets there when
+        // the last reference was dropped and the zero queued to the owner
+        if (total <= 0)
+            return false;
+        // fails if the counts were merged meanwhile
+        if (c.shared.compare_exchange_weak(word, word + one,
+                                           std::memory_order_relaxed))
+            return true;
+    }
+}
+
+namespace detail {
+
+template <class Policy> struct weak_policy {
+    using type = Policy;
+};
+
+template <class Policy>
+    requires requires { typename Policy::weak_policy; }
+struct weak_policy<Policy> {
+    using type = typename Policy::weak_policy;
+};
+
+template <class Policy>
+using weak_policy_t = typename weak_policy<Policy>::type;
+
+} // namespace detail
+
+} // namespace mystd
@@ -1,12 +1,25 @@
 #pragma once
 
+#include "ref_count.hpp"
+#include "scope.hpp"
 #include "unique_ptr.hpp"
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <exception>
-
-// count2 is only for testing purpose
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// count2 is the number of live control blocks, only for testing purpose
+//  - compiled in only when MYSTD_INSTRUMENT_CONTROL_BLOCK is defined, otherwise
+//    every block would touch one process-wide atomic when created and freed
+#ifdef MYSTD_INSTRUMENT_CONTROL_BLOCK
 inline std::atomic<int> count2{0};
+#endif
 
 namespace mystd {
 
@@ -15,81 +28,334 @@ class bad_weak_ptr : public std::exception {
 };
 
 // forward declaration
-template <class T> class shared_ptr;
+// Policy is one of the reference count policies in ref_count.hpp
+template <class T, class Policy = multi_threaded> class shared_ptr;
 
-template <class T> class weak_ptr;
+template <class T, class Policy = multi_threaded> class weak_ptr;
 
-template <class T> class enable_shared_from_this;
+template <class T, class Policy = multi_threaded>
+class enable_shared_from_this;
 
 namespace detail {
 
-template <class T>
-concept inherits_from_enable_shared_from_this =
-    requires(T t) { t.shared_from_this(); };
+// only an enable_shared_from_this with the same policy is hooked up
+template <class T, class Policy = multi_threaded>
+concept inherits_from_enable_shared_from_this = requires(T &t) {
+    t.shared_from_this();
+    requires std::same_as<
+        typename decltype(t.shared_from_this())::policy_type, Policy>;
+};
+
+// `shared_ptr<T>(U *)` takes over a U, or for T = V[] the first element of
+// an array of U
+template <class U, class T>
+concept ownable_by =
+    (std::is_unbounded_array_v<T> && pointer_convertible_to<U[], T>) ||
+    (!std::is_array_v<T> && pointer_convertible_to<U, T>);
+
+// the deleter of `shared_ptr<T>(U *)`
+template <class U, class T> struct default_delete_for {
+    using type = default_delete<U>;
+};
+
+template <class U, class T> struct default_delete_for<U, T[]> {
+    using type = default_delete<U[]>;
+};
+
+// asks for default-initialization instead of value-initialization, which
+// leaves trivially constructible objects uninitialized
+struct for_overwrite_t {
+    explicit for_overwrite_t() = default;
+};
+
+inline constexpr for_overwrite_t for_overwrite{};
+
+template <class U, class Policy, class Alloc, class... Args>
+auto allocate_shared_with(const Alloc &alloc, Args &&...args)
+    -> shared_ptr<U, Policy>;
+
+template <class U, class Policy, class Alloc, class... Init>
+auto allocate_shared_array(const Alloc &alloc, std::size_t n, Init... init)
+    -> shared_ptr<U, Policy>;
 
 // ****************************************************************************
 // *                              control_block                               *
 // ****************************************************************************
 
-struct control_block_base {
-    std::atomic<std::size_t> shared_count = 1; // #shared
-    std::atomic<std::size_t> weak_count = 1;   // #weak + (#shared != 0)
-    virtual auto delete_obj() -> void = 0;
+// what a control block manager is asked to do
+enum class block_op { delete_obj, destroy, delete_obj_and_destroy };
+
+template <class Policy> struct control_block_base;
+
+template <class Policy>
+using block_manager_t =
+    void (*)(control_block_base<Policy> *, block_op) noexcept;
+
+// each control block type is erased behind one manager function, instead of
+// a vtable with a virtual `delete_obj` and a virtual destructor
+//  - releasing the last reference of an object without weak references
+//    (e.g. from `make_shared`) is a single indirect call
+template <class Block>
+auto manage_block(control_block_base<typename Block::policy_type> *base,
+                  block_op op) noexcept -> void {
+    auto block = static_cast<Block *>(base);
+    if (op != block_op::destroy)
+        block->delete_obj();
+    if (op != block_op::delete_obj)
+        block->destroy();
+}
 
-    control_block_base() { count2++; }
-    virtual ~control_block_base() { count2--; }
-    void decrement_shared() {
-        if (shared_count.fetch_sub(1, std::memory_order_release) == 1) {
-            std::atomic_thread_fence(std::memory_order_acquire);
-            delete_obj();
-            if (weak_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
-                ::delete this;
-            }
+// the counts are updated only through Policy, and the weak count through its
+// weak_policy
+template <class Policy> struct control_block_base {
+    using policy_type = Policy;
+    using weak_policy = weak_policy_t<Policy>;
+
+    typename Policy::count_type shared_count{1};    // #shared
+    typename weak_policy::count_type weak_count{1}; // #weak + (#shared != 0)
+    block_manager_t<Policy> manager;
+
+    explicit control_block_base(block_manager_t<Policy> m) noexcept
+        : manager{m} {
+#ifdef MYSTD_INSTRUMENT_CONTROL_BLOCK
+        count2++;
+#endif
+        if constexpr (requires { shared_count.on_zero; }) {
+            // the shared count may find out later that it dropped to zero
+            shared_count.on_zero = [](void *self) noexcept {
+                static_cast<control_block_base *>(self)->release_shared();
+            };
+            shared_count.context = this;
         }
     }
 
+    void increment_shared() noexcept { Policy::increment(shared_count); }
+
+    void increment_weak() noexcept { weak_policy::increment(weak_count); }
+
+    auto try_increment_shared() noexcept -> bool {
+        return Policy::increment_if_not_zero(shared_count);
+    }
+
+    auto use_count() const noexcept -> std::size_t {
+        return Policy::load(shared_count);
+    }
+
+    void decrement_shared() {
+        if (Policy::decrement(shared_count))
+            release_shared();
+    }
+
     void decrement_weak() {
-        if (weak_count.fetch_sub(1, std::memory_order_acquire) == 1) {
-            ::delete this;
+        if (weak_policy::decrement(weak_count)) {
+            manager(this, block_op::destroy);
         }
     }
-};
 
-template <class T, class Deleter = default_delete<T>>
-struct control_block : control_block_base {
-    [[no_unique_address]] Deleter deleter{};
+    // the shared count has dropped to zero
+    void release_shared() noexcept {
+        // no weak_ptr is left and none can be created from a dead object,
+        // so the block can be freed without touching weak_count
+        if (weak_policy::load_acquire(weak_count) == 1) {
+            manager(this, block_op::delete_obj_and_destroy);
+            return;
+        }
+        manager(this, block_op::delete_obj);
+        if (weak_policy::decrement(weak_count)) {
+            manager(this, block_op::destroy);
+        }
+    }
 
-    control_block() noexcept = default;
-    control_block(Deleter d) noexcept : deleter{d} {}
-    virtual ~control_block() = default;
+  protected:
+    // not virtual, blocks are destroyed by their manager
+#ifdef MYSTD_INSTRUMENT_CONTROL_BLOCK
+    ~control_block_base() { count2--; }
+#else
+    ~control_block_base() = default;
+#endif
 };
 
-template <class T, class Deleter = default_delete<T>>
-struct control_block_with_ptr : control_block<T, Deleter> {
+template <class Block, class Alloc>
+using block_allocator_t =
+    typename std::allocator_traits<Alloc>::template rebind_alloc<Block>;
+
+// allocates a Block with alloc rebound to Block, then constructs it from args
+template <class Block, class Alloc, class... Args>
+auto allocate_block(const Alloc &alloc, Args &&...args) -> Block * {
+    using traits = std::allocator_traits<block_allocator_t<Block, Alloc>>;
+    block_allocator_t<Block, Alloc> block_alloc(alloc);
+    auto block = traits::allocate(block_alloc, 1);
+    scope_exit guard{[&] { traits::deallocate(block_alloc, block, 1); }};
+    std::construct_at(block, std::forward<Args>(args)...);
+    guard.release();
+    return block;
+}
+
+// the allocator lives inside the block, so it is taken by value: the copy
+// outlives the block and frees its memory
+template <class Block, class Alloc>
+auto deallocate_block(Block *block, Alloc alloc) noexcept -> void {
+    using traits = std::allocator_traits<block_allocator_t<Block, Alloc>>;
+    block_allocator_t<Block, Alloc> block_alloc(alloc);
+    std::destroy_at(block);
+    traits::deallocate(block_alloc, block, 1);
+}
+
+// the object is owned through a pointer and destroyed by the deleter, the
+// block itself is allocated from Alloc
+template <class T, class Deleter = default_delete<T>,
+          class Alloc = std::allocator<T>, class Policy = multi_threaded>
+struct control_block_with_ptr final : control_block_base<Policy> {
     T *ptr = nullptr;
+    [[no_unique_address]] Deleter deleter{};
+    [[no_unique_address]] Alloc alloc{};
+
+    using base = control_block_base<Policy>;
 
-    control_block_with_ptr() noexcept = default;
-    control_block_with_ptr(T *p) noexcept : ptr{p} {}
+    control_block_with_ptr() noexcept
+        : base(&manage_block<control_block_with_ptr>) {}
+    control_block_with_ptr(T *p) noexcept
+        : base(&manage_block<control_block_with_ptr>), ptr{p} {}
     control_block_with_ptr(T *p, Deleter d) noexcept
-        : control_block<T, Deleter>(d), ptr{p} {}
-    virtual ~control_block_with_ptr() = default;
-    auto delete_obj() -> void override { this->deleter(ptr); }
+        : base(&manage_block<control_block_with_ptr>), ptr{p},
+          deleter{std::move(d)} {}
+    control_block_with_ptr(T *p, Deleter d, const Alloc &a) noexcept
+        : base(&manage_block<control_block_with_ptr>), ptr{p},
+          deleter{std::move(d)}, alloc{a} {}
+
+    auto delete_obj() noexcept -> void { deleter(ptr); }
+    auto destroy() noexcept -> void { deallocate_block(this, alloc); }
 };
 
-template <class T> struct control_block_with_obj : control_block<T> {
+// the object is stored in the block, constructed and destroyed through Alloc
+// (rebound to T), as `std::allocate_shared` does
+template <class T, class Alloc = std::allocator<std::remove_cv_t<T>>,
+          class Policy = multi_threaded>
+struct control_block_with_obj final : control_block_base<Policy> {
     alignas(T) std::array<std::byte, sizeof(T)> storage;
+    [[no_unique_address]] Alloc alloc{};
 
-    control_block_with_obj() noexcept = default;
-    virtual ~control_block_with_obj() = default;
+    using base = control_block_base<Policy>;
 
-    auto delete_obj() -> void override {
-        std::destroy_at(static_cast<T *>(static_cast<void *>(storage.data())));
+    control_block_with_obj() noexcept
+        : base(&manage_block<control_block_with_obj>) {}
+    explicit control_block_with_obj(const Alloc &a) noexcept
+        : base(&manage_block<control_block_with_obj>), alloc{a} {}
+
+    auto delete_obj() noexcept -> void {
+        std::allocator_traits<Alloc>::destroy(alloc, get());
     }
 
+    auto destroy() noexcept -> void { deallocate_block(this, alloc); }
+
     template <class... Args> auto emplace(Args &&...args) -> T * {
+        std::allocator_traits<Alloc>::construct(alloc, get(),
+                                                std::forward<Args>(args)...);
+        return get();
+    }
+
+    auto emplace(for_overwrite_t) -> T * {
+        ::new (static_cast<void *>(get())) T;
+        return get();
+    }
+
+    auto get() noexcept -> T * {
+        return static_cast<T *>(static_cast<void *>(storage.data()));
+    }
+};
+
+template <std::size_t Align> struct alignas(Align) array_block_unit {
+    std::byte bytes[Align];
+};
+
+// n elements stored right after the block, in the same allocation, as
+// `make_shared<T[]>(n)` does
+//  - constructed and destroyed through Alloc (rebound to T), the elements
+//    are destroyed in reverse order
+template <class T, class Alloc = std::allocator<T>,
+          class Policy = multi_threaded>
+struct control_block_with_array final : control_block_base<Policy> {
+    std::size_t size;
+    [[no_unique_address]] Alloc alloc;
+
+    using base = control_block_base<Policy>;
+
+    control_block_with_array(std::size_t n, const Alloc &a) noexcept
+        : base(&manage_block<control_block_with_array>), size{n}, alloc{a} {}
+
+    // allocates a block followed by room for n elements, which are not
+    // constructed
+    static auto allocate(std::size_t n, const Alloc &a)
+        -> control_block_with_array * {
+        using traits = std::allocator_traits<unit_allocator>;
+        unit_allocator units_alloc(a);
+        auto p = traits::allocate(units_alloc, units(n));
         return std::construct_at(
-            static_cast<T *>(static_cast<void *>(storage.data())),
-            std::forward<Args>(args)...);
+            static_cast<control_block_with_array *>(static_cast<void *>(p)),
+            n, a);
+    }
+
+    auto delete_obj() noexcept -> void {
+        for (auto i = size; i != 0; i--)
+            std::allocator_traits<Alloc>::destroy(alloc, get() + i - 1);
+    }
+
+    auto destroy() noexcept -> void {
+        using traits = std::allocator_traits<unit_allocator>;
+        // the allocator lives inside the block, see deallocate_block
+        unit_allocator units_alloc(alloc);
+        auto count = units(size);
+        std::destroy_at(this);
+        traits::deallocate(units_alloc,
+                           static_cast<unit *>(static_cast<void *>(this)),
+                           count);
+    }
+
+    // value-initialized elements, e.g. zeros
+    auto construct() -> T * {
+        if constexpr (std::is_same_v<Alloc, std::allocator<T>>) {
+            // a memset for trivial types
+            std::uninitialized_value_construct_n(get(), size);
+        } else {
+            std::size_t i = 0;
+            scope_exit guard{[&] {
+                while (i != 0)
+                    std::allocator_traits<Alloc>::destroy(alloc, get() + --i);
+            }};
+            for (; i < size; i++)
+                std::allocator_traits<Alloc>::construct(alloc, get() + i);
+            guard.release();
+        }
+        return get();
+    }
+
+    // default-initialized elements, nothing to do for trivial types
+    auto construct(for_overwrite_t) -> T * {
+        std::uninitialized_default_construct_n(get(), size);
+        return get();
+    }
+
+    auto get() noexcept -> T * {
+        return static_cast<T *>(static_cast<void *>(
+            static_cast<std::byte *>(static_cast<void *>(this)) + offset()));
+    }
+
+  private:
+    // aligned for every member of the block and for T
+    using unit = array_block_unit<std::max(
+        {alignof(base), alignof(std::size_t), alignof(Alloc), alignof(T)})>;
+    using unit_allocator = block_allocator_t<unit, Alloc>;
+
+    // the elements start at the first multiple of alignof(T) after the block
+    static constexpr auto offset() noexcept -> std::size_t {
+        return (sizeof(control_block_with_array) + alignof(T) - 1) /
+               alignof(T) * alignof(T);
+    }
+
+    static constexpr auto units(std::size_t n) -> std::size_t {
+        if (n > (std::size_t(-1) - offset() - sizeof(unit)) / sizeof(T))
+            throw std::bad_array_new_length{};
+        return (offset() + n * sizeof(T) + sizeof(unit) - 1) / sizeof(unit);
     }
 };
 
@@ -99,11 +365,17 @@ template <class T> struct control_block_with_obj : control_block<T> {
 // *                              shared_ptr                                  *
 // ****************************************************************************
 
-template <class T> class shared_ptr {
+// for T = U[], the object is an array of U and `operator[]` replaces
+// `operator*` and `operator->`
+template <class T, class Policy> class shared_ptr {
   public:
     // member types
-    using element_type = T;
-    using weak_type = weak_ptr<T>;
+    using element_type = std::remove_extent_t<T>;
+    using weak_type = weak_ptr<T, Policy>;
+    using policy_type = Policy;
+
+    // two raw pointers, the reference counts live in the control block
+    using trivially_relocatable = std::true_type;
 
     // null constructors
     constexpr shared_ptr() noexcept : _ptr{nullptr}, _cb_ptr{nullptr} {}
@@ -111,19 +383,24 @@ template <class T> class shared_ptr {
         : _ptr{nullptr}, _cb_ptr{nullptr} {}
 
     // regular constructors
-    template <detail::pointer_convertible_to<T> U>
+    // if allocating the control block throws, the object is deleted
+    // for T = V[], ptr is deleted with `delete[]`
+    template <detail::ownable_by<T> U>
     explicit shared_ptr(U *ptr)
-        : _ptr{ptr}, _cb_ptr{new detail::control_block_with_ptr<U>(ptr)} {
-        if constexpr (detail::inherits_from_enable_shared_from_this<T>) {
-            // derive from enable_shared_from_this
-            _ptr->_weak_this = *this;
-        }
-    }
+        : shared_ptr(ptr, typename detail::default_delete_for<U, T>::type{},
+                     std::allocator<U>{}) {}
 
-    template <detail::pointer_convertible_to<T> U, std::invocable<U *> Deleter>
+    template <detail::ownable_by<T> U, std::invocable<U *> Deleter>
     shared_ptr(U *ptr, Deleter d)
-        : _ptr{ptr}, _cb_ptr{new detail::control_block_with_ptr<U>(ptr, d)} {
-        if constexpr (detail::inherits_from_enable_shared_from_this<T>) {
+        : shared_ptr(ptr, std::move(d), std::allocator<U>{}) {}
+
+    // the control block is allocated from alloc
+    template <detail::ownable_by<T> U, std::invocable<U *> Deleter,
+              class Alloc>
+    shared_ptr(U *ptr, Deleter d, Alloc alloc)
+        : _ptr{ptr}, _cb_ptr{make_block(ptr, d, alloc)} {
+        if constexpr (detail::inherits_from_enable_shared_from_this<T,
+                                                                    Policy>) {
             // derive from enable_shared_from_this
             _ptr->_weak_this = *this;
         }
@@ -133,7 +410,7 @@ template <class T> class shared_ptr {
     shared_ptr(const shared_ptr &other) noexcept
         : _ptr{other._ptr}, _cb_ptr{other._cb_ptr} {
         if (_ptr != nullptr)
-            _cb_ptr->shared_count.fetch_add(1, std::memory_order_relaxed);
+            _cb_ptr->increment_shared();
     }
     shared_ptr(shared_ptr &&other) noexcept
         : _ptr{std::exchange(other._ptr, nullptr)}, _cb_ptr{std::exchange(
@@ -141,21 +418,21 @@ template <class T> class shared_ptr {
                                                         nullptr)} {}
 
     template <detail::pointer_convertible_to<T> U>
-    shared_ptr(const shared_ptr<U> &other) noexcept
+    shared_ptr(const shared_ptr<U, Policy> &other) noexcept
         : _ptr{other._ptr}, _cb_ptr{other._cb_ptr} {
         if (_ptr != nullptr)
-            _cb_ptr->shared_count.fetch_add(1, std::memory_order_relaxed);
+            _cb_ptr->increment_shared();
     }
 
     template <detail::pointer_convertible_to<T> U>
-    shared_ptr(shared_ptr<U> &&other) noexcept
+    shared_ptr(shared_ptr<U, Policy> &&other) noexcept
         : _ptr{std::exchange(other._ptr, nullptr)}, _cb_ptr{std::exchange(
                                                         other._cb_ptr,
                                                         nullptr)} {}
 
     // constructed from other smart pointers
     template <detail::pointer_convertible_to<T> U>
-    shared_ptr(const weak_ptr<U> &r) : _ptr{nullptr}, _cb_ptr{nullptr} {
+    shared_ptr(const weak_ptr<U, Policy> &r) : _ptr{nullptr}, _cb_ptr{nullptr} {
         shared_ptr(r.lock()).swap(*this);
         if (_cb_ptr == nullptr)
             throw bad_weak_ptr{};
@@ -164,16 +441,24 @@ template <class T> class shared_ptr {
     template <detail::pointer_convertible_to<T> U, class Deleter>
     shared_ptr(unique_ptr<U, Deleter> &&r) {
         if (r) {
+            // r still owns the object if allocating the block throws
+            using V = std::remove_extent_t<U>;
             if constexpr (std::is_reference_v<Deleter>) {
-                _cb_ptr = ::new detail::control_block_with_ptr<U>(
-                    r.get(), r.get_deleter());
+                using block = detail::control_block_with_ptr<
+                    V, std::reference_wrapper<std::remove_reference_t<Deleter>>,
+                    std::allocator<V>, Policy>;
+                _cb_ptr = detail::allocate_block<block>(
+                    std::allocator<V>{}, r.get(), std::ref(r.get_deleter()));
             } else {
-                _cb_ptr = ::new detail::control_block_with_ptr<U>(
-                    r.get(), std::move(r.get_deleter()));
+                using block = detail::control_block_with_ptr<
+                    V, Deleter, std::allocator<V>, Policy>;
+                _cb_ptr = detail::allocate_block<block>(
+                    std::allocator<V>{}, r.get(), std::move(r.get_deleter()));
             }
             _ptr = r.release();
 
-            if constexpr (detail::inherits_from_enable_shared_from_this<T>) {
+            if constexpr (detail::inherits_from_enable_shared_from_this<T,
+                                                                    Policy>) {
                 // derive from enable_shared_from_this
                 _ptr->_weak_this = *this;
             }
@@ -185,14 +470,14 @@ template <class T> class shared_ptr {
 
     // aliasing constructors
     template <class U>
-    shared_ptr(const shared_ptr<U> &r, element_type *ptr) noexcept
+    shared_ptr(const shared_ptr<U, Policy> &r, element_type *ptr) noexcept
         : _ptr{ptr}, _cb_ptr{r._cb_ptr} {
         if (r)
-            _cb_ptr->shared_count.fetch_add(1, std::memory_order_relaxed);
+            _cb_ptr->increment_shared();
     }
 
     template <class U>
-    shared_ptr(shared_ptr<U> &&r, element_type *ptr) noexcept
+    shared_ptr(shared_ptr<U, Policy> &&r, element_type *ptr) noexcept
         : _ptr{ptr}, _cb_ptr{std::exchange(r._cb_ptr, nullptr)} {
         r._ptr = nullptr;
     }
@@ -212,12 +497,12 @@ template <class T> class shared_ptr {
         _ptr = rhs._ptr;
         _cb_ptr = rhs._cb_ptr;
         if (_cb_ptr != nullptr)
-            _cb_ptr->shared_count.fetch_add(1, std::memory_order_relaxed);
+            _cb_ptr->increment_shared();
         return *this;
     }
 
     template <detail::pointer_convertible_to<T> U>
-    auto operator=(const shared_ptr<U> &rhs) noexcept -> shared_ptr & {
+    auto operator=(const shared_ptr<U, Policy> &rhs) noexcept -> shared_ptr & {
         if (_cb_ptr == rhs._cb_ptr) {
             // if points to the same control block,
             //  do not need to change reference counts
@@ -228,7 +513,7 @@ template <class T> class shared_ptr {
         _ptr = rhs._ptr;
         _cb_ptr = rhs._cb_ptr;
         if (_cb_ptr != nullptr)
-            _cb_ptr->shared_count.fetch_add(1, std::memory_order_relaxed);
+            _cb_ptr->increment_shared();
         return *this;
     }
 
@@ -243,7 +528,7 @@ template <class T> class shared_ptr {
     }
 
     template <detail::pointer_convertible_to<T> U>
-    auto operator=(shared_ptr<U> &&rhs) noexcept -> shared_ptr & {
+    auto operator=(shared_ptr<U, Policy> &&rhs) noexcept -> shared_ptr & {
         if (this == &rhs)
             return *this;
         reset();
@@ -274,37 +559,49 @@ template <class T> class shared_ptr {
         }
     }
 
-    template <detail::pointer_convertible_to<T> U> auto reset(U *ptr) -> void {
-        reset();
-        _ptr = ptr;
-        _cb_ptr = ::new detail::control_block_with_ptr<U>(ptr);
+    template <detail::ownable_by<T> U> auto reset(U *ptr) -> void {
+        shared_ptr(ptr).swap(*this);
     }
 
-    template <detail::pointer_convertible_to<T> U, std::invocable<U *> Deleter>
+    template <detail::ownable_by<T> U, std::invocable<U *> Deleter>
     auto reset(U *ptr, Deleter d) -> void {
-        reset();
-        _ptr = ptr;
-        _cb_ptr = ::new detail::control_block_with_ptr<U>(ptr, d);
+        shared_ptr(ptr, std::move(d)).swap(*this);
+    }
+
+    template <detail::ownable_by<T> U, std::invocable<U *> Deleter,
+              class Alloc>
+    auto reset(U *ptr, Deleter d, Alloc alloc) -> void {
+        shared_ptr(ptr, std::move(d), std::move(alloc)).swap(*this);
     }
 
     // observers
     auto get() const noexcept -> element_type * { return _ptr; }
     auto operator*() const noexcept(noexcept(*std::declval<element_type *>()))
-        -> element_type & {
+        -> element_type &
+        requires(!std::is_array_v<T>)
+    {
         return *get();
     }
-    auto operator->() const noexcept -> element_type * { return get(); }
+    auto operator->() const noexcept -> element_type *
+        requires(!std::is_array_v<T>)
+    {
+        return get();
+    }
+    auto operator[](std::ptrdiff_t i) const -> element_type &
+        requires std::is_array_v<T>
+    {
+        return get()[i];
+    }
 
     auto use_count() const noexcept -> long {
-        return _cb_ptr ? _cb_ptr->shared_count.load(std::memory_order_relaxed)
-                       : 0;
+        return _cb_ptr ? _cb_ptr->use_count() : 0;
     }
     explicit operator bool() const noexcept { return get() != nullptr; }
 
     // comparison
     template <class U>
-    [[nodiscard]] auto operator==(const shared_ptr<U> &rhs) const noexcept
-        -> bool {
+    [[nodiscard]] auto
+    operator==(const shared_ptr<U, Policy> &rhs) const noexcept -> bool {
         return get() == rhs.get();
     }
 
@@ -312,42 +609,143 @@ template <class T> class shared_ptr {
         return get() == nullptr;
     }
 
+    // same control block, whatever the stored pointers
+    template <class U>
+    [[nodiscard]] auto
+    owner_equal(const shared_ptr<U, Policy> &rhs) const noexcept -> bool {
+        return _cb_ptr == rhs._cb_ptr;
+    }
+
   private:
     element_type *_ptr;
-    detail::control_block_base *_cb_ptr;
-
-    template <class U> friend class shared_ptr;
-    template <class U> friend class weak_ptr;
-
-    template <class U, class... Args>
-    friend auto make_shared(Args &&...args) -> shared_ptr<U>;
+    detail::control_block_base<Policy> *_cb_ptr;
+
+    template <class U, class P> friend class shared_ptr;
+    template <class U, class P> friend class weak_ptr;
+
+    template <class U, class P, class Alloc, class... Args>
+    friend auto detail::allocate_shared_with(const Alloc &alloc,
+                                             Args &&...args)
+        -> shared_ptr<U, P>;
+
+    template <class U, class P, class Alloc, class... Init>
+    friend auto detail::allocate_shared_array(const Alloc &alloc,
+                                              std::size_t n, Init... init)
+        -> shared_ptr<U, P>;
+
+    template <class U, class Deleter, class Alloc>
+    static auto make_block(U *ptr, Deleter &d, const Alloc &alloc)
+        -> detail::control_block_base<Policy> * {
+        try {
+            return detail::allocate_block<
+                detail::control_block_with_ptr<U, Deleter, Alloc, Policy>>(
+                alloc, ptr, std::move(d), alloc);
+        } catch (...) {
+            d(ptr);
+            throw;
+        }
+    }
 };
 
 // deduction guides
-template <class T> shared_ptr(weak_ptr<T>) -> shared_ptr<T>;
+template <class T, class P> shared_ptr(weak_ptr<T, P>) -> shared_ptr<T, P>;
 
 template <class T, class D> shared_ptr(unique_ptr<T, D>) -> shared_ptr<T>;
 
-template <class U, class... Args>
-auto make_shared(Args &&...args) -> shared_ptr<U> {
-    shared_ptr<U> sp{};
-    auto cb_ptr = ::new detail::control_block_with_obj<U>{};
-    sp._ptr = cb_ptr->emplace(std::forward<Args>(args)...);
-    sp._cb_ptr = cb_ptr;
+namespace detail {
 
-    if constexpr (detail::inherits_from_enable_shared_from_this<U>) {
-        // derive from enable_shared_from_this
-        sp._ptr->_weak_this = sp;
+// the object and the control block share one allocation from alloc
+//  - for U = T[], args are the number of elements, optionally followed by
+//    `for_overwrite`
+template <class U, class Policy, class Alloc, class... Args>
+auto allocate_shared_with(const Alloc &alloc, Args &&...args)
+    -> shared_ptr<U, Policy> {
+    if constexpr (std::is_unbounded_array_v<U>) {
+        return allocate_shared_array<U, Policy>(alloc,
+                                                std::forward<Args>(args)...);
+    } else {
+        using object_alloc = typename std::allocator_traits<
+            Alloc>::template rebind_alloc<std::remove_cv_t<U>>;
+        using block = control_block_with_obj<U, object_alloc, Policy>;
+
+        auto cb_ptr = allocate_block<block>(alloc, object_alloc(alloc));
+        // if the object constructor throws, only the block is freed
+        scope_exit guard{[&] { cb_ptr->destroy(); }};
+        shared_ptr<U, Policy> sp{};
+        sp._ptr = cb_ptr->emplace(std::forward<Args>(args)...);
+        guard.release();
+        sp._cb_ptr = cb_ptr;
+
+        if constexpr (inherits_from_enable_shared_from_this<U, Policy>) {
+            // derive from enable_shared_from_this
+            sp._ptr->_weak_this = sp;
+        }
+        return sp;
     }
+}
+
+// the n elements of U = T[] and the control block share one allocation
+template <class U, class Policy, class Alloc, class... Init>
+auto allocate_shared_array(const Alloc &alloc, std::size_t n, Init... init)
+    -> shared_ptr<U, Policy> {
+    using T = std::remove_cv_t<std::remove_extent_t<U>>;
+    using object_alloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+    using block = control_block_with_array<T, object_alloc, Policy>;
+
+    auto cb_ptr = block::allocate(n, object_alloc(alloc));
+    // if an element constructor throws, only the block is freed
+    scope_exit guard{[&] { cb_ptr->destroy(); }};
+    shared_ptr<U, Policy> sp{};
+    sp._ptr = cb_ptr->construct(init...);
+    guard.release();
+    sp._cb_ptr = cb_ptr;
     return sp;
 }
 
+} // namespace detail
+
+template <class U, class Alloc, class... Args>
+auto allocate_shared(const Alloc &alloc, Args &&...args) -> shared_ptr<U> {
+    return detail::allocate_shared_with<U, multi_threaded>(
+        alloc, std::forward<Args>(args)...);
+}
+
+// `make_shared<T[]>(n)`: n value-initialized elements in the same
+// allocation as the control block
+template <class U, class... Args>
+auto make_shared(Args &&...args) -> shared_ptr<U> {
+    // qualified, std::allocate_shared would be found by ADL
+    return mystd::allocate_shared<U>(
+        std::allocator<std::remove_cv_t<std::remove_extent_t<U>>>{},
+        std::forward<Args>(args)...);
+}
+
+// default-initialized, a trivially constructible object is left
+// uninitialized, for buffers that are written before they are read
+template <class U>
+    requires(!std::is_array_v<U>)
+auto make_shared_for_overwrite() -> shared_ptr<U> {
+    return detail::allocate_shared_with<U, multi_threaded>(
+        std::allocator<std::remove_cv_t<U>>{}, detail::for_overwrite);
+}
+
+template <class U>
+    requires std::is_unbounded_array_v<U>
+auto make_shared_for_overwrite(std::size_t n) -> shared_ptr<U> {
+    return detail::allocate_shared_with<U, multi_threaded>(
+        std::allocator<std::remove_cv_t<std::remove_extent_t<U>>>{}, n,
+        detail::for_overwrite);
+}
+
 // ****************************************************************************
 // *                              weak_ptr                                    *
 // ****************************************************************************
-template <class T> class weak_ptr {
+template <class T, class Policy> class weak_ptr {
   public:
-    using element_type = T;
+    using element_type = std::remove_extent_t<T>;
+    using policy_type = Policy;
+    using trivially_relocatable = std::true_type;
 
     // constructors
     constexpr weak_ptr() noexcept : _ptr{nullptr}, _cb_ptr{nullptr} {}
@@ -356,21 +754,21 @@ template <class T> class weak_ptr {
     weak_ptr(const weak_ptr &other) noexcept
         : _ptr{other._ptr}, _cb_ptr{other._cb_ptr} {
         if (_cb_ptr)
-            _cb_ptr->weak_count.fetch_add(1, std::memory_order_relaxed);
+            _cb_ptr->increment_weak();
     }
 
     template <detail::pointer_convertible_to<T> U>
-    weak_ptr(const weak_ptr<U> &other) noexcept
+    weak_ptr(const weak_ptr<U, Policy> &other) noexcept
         : _ptr{other._ptr}, _cb_ptr{other._cb_ptr} {
         if (_cb_ptr)
-            _cb_ptr->weak_count.fetch_add(1, std::memory_order_relaxed);
+            _cb_ptr->increment_weak();
     }
 
     template <detail::pointer_convertible_to<T> U>
-    weak_ptr(const shared_ptr<U> &other) noexcept
+    weak_ptr(const shared_ptr<U, Policy> &other) noexcept
         : _ptr{other._ptr}, _cb_ptr{other._cb_ptr} {
         if (_cb_ptr)
-            _cb_ptr->weak_count.fetch_add(1, std::memory_order_relaxed);
+            _cb_ptr->increment_weak();
     }
 
     // move constructors
@@ -380,7 +778,7 @@ template <class T> class weak_ptr {
                                                         nullptr)} {}
 
     template <detail::pointer_convertible_to<T> U>
-    weak_ptr(weak_ptr<U> &&other) noexcept
+    weak_ptr(weak_ptr<U, Policy> &&other) noexcept
         : _ptr{std::exchange(other._ptr, nullptr)}, _cb_ptr{std::exchange(
                                                         other._cb_ptr,
                                                         nullptr)} {}
@@ -397,18 +795,19 @@ template <class T> class weak_ptr {
         return *this;
     }
 
-    template <class U> auto operator=(weak_ptr<U> rhs) noexcept -> weak_ptr & {
+    template <class U>
+    auto operator=(weak_ptr<U, Policy> rhs) noexcept -> weak_ptr & {
         weak_ptr(std::move(rhs)).swap(*this);
         return *this;
     }
 
     template <detail::pointer_convertible_to<T> U>
-    auto operator=(const shared_ptr<U> &rhs) noexcept -> weak_ptr & {
+    auto operator=(const shared_ptr<U, Policy> &rhs) noexcept -> weak_ptr & {
         reset();
         _ptr = rhs._ptr;
         _cb_ptr = rhs._cb_ptr;
         if (_cb_ptr)
-            _cb_ptr->weak_count.fetch_add(1, std::memory_order_relaxed);
+            _cb_ptr->increment_weak();
         return *this;
     }
 
@@ -428,25 +827,15 @@ template <class T> class weak_ptr {
 
     // observers
     auto use_count() const noexcept -> long {
-        return _cb_ptr ? _cb_ptr->shared_count.load(std::memory_order_relaxed)
-                       : 0;
+        return _cb_ptr ? _cb_ptr->use_count() : 0;
     }
 
     auto expired() const noexcept -> bool { return use_count() == 0; }
 
-    auto lock() const noexcept -> shared_ptr<T> {
-        shared_ptr<T> sp{};
-        if (_cb_ptr) {
-            // perform lock-free add-if-not-zero operation
-            auto count = _cb_ptr->shared_count.load(std::memory_order_relaxed);
-            do {
-                if (count == 0)
-                    return sp;
-            } while (_cb_ptr->shared_count.compare_exchange_weak(
-                count, count + 1, std::memory_order_relaxed));
-            // use std::memory_order_relaxed here because there is nothing to
-            // acquire or release
-
+    auto lock() const noexcept -> shared_ptr<T, Policy> {
+        shared_ptr<T, Policy> sp{};
+        // add-if-not-zero, lock-free for multi_threaded
+        if (_cb_ptr && _cb_ptr->try_increment_shared()) {
             sp._ptr = _ptr;
             sp._cb_ptr = _cb_ptr;
         }
@@ -456,19 +845,19 @@ template <class T> class weak_ptr {
 
   private:
     element_type *_ptr;
-    detail::control_block_base *_cb_ptr;
+    detail::control_block_base<Policy> *_cb_ptr;
 
-    template <class U> friend class weak_ptr;
+    template <class U, class P> friend class weak_ptr;
 };
 
 // deduction guide for weak_ptr
-template <class T> weak_ptr(shared_ptr<T>) -> weak_ptr<T>;
+template <class T, class P> weak_ptr(shared_ptr<T, P>) -> weak_ptr<T, P>;
 
 // ****************************************************************************
 // *                      enable_shared_from_this                             *
 // ****************************************************************************
 
-template <class T> class enable_shared_from_this {
+template <class T, class Policy> class enable_shared_from_this {
   protected:
     // constructors
     constexpr enable_shared_from_this() noexcept = default;
@@ -486,29 +875,88 @@ template <class T> class enable_shared_from_this {
     }
 
   public:
-    auto shared_from_this() -> shared_ptr<T> {
-        return shared_ptr<T>(_weak_this);
+    auto shared_from_this() -> shared_ptr<T, Policy> {
+        return shared_ptr<T, Policy>(_weak_this);
     }
 
-    auto shared_from_this() const -> shared_ptr<T const> {
-        return shared_ptr<T const>(_weak_this);
+    auto shared_from_this() const -> shared_ptr<T const, Policy> {
+        return shared_ptr<T const, Policy>(_weak_this);
     }
 
-    auto weak_from_this() noexcept -> weak_ptr<T> {
-        return weak_ptr<T>(_weak_this);
+    auto weak_from_this() noexcept -> weak_ptr<T, Policy> {
+        return weak_ptr<T, Policy>(_weak_this);
     }
 
-    auto weak_from_this() const noexcept -> weak_ptr<T const> {
-        return weak_ptr<T const>(_weak_this);
+    auto weak_from_this() const noexcept -> weak_ptr<T const, Policy> {
+        return weak_ptr<T const, Policy>(_weak_this);
     }
 
   private:
-    weak_ptr<T> _weak_this{};
+    weak_ptr<T, Policy> _weak_this{};
 
-    friend class shared_ptr<T>;
+    friend class shared_ptr<T, Policy>;
 
-    template <class U, class... Args>
-    friend auto make_shared(Args &&...args) -> shared_ptr<U>;
+    template <class U, class P, class Alloc, class... Args>
+    friend auto detail::allocate_shared_with(const Alloc &alloc,
+                                             Args &&...args)
+        -> shared_ptr<U, P>;
 };
 
+// ****************************************************************************
+// *                            local_shared_ptr                              *
+// ****************************************************************************
+
+// same control blocks, but the counts are plain integers
+//  - for objects that never leave the thread that created them, none of the
+//    pointers may be copied, destroyed or locked from another thread
+template <class T> using local_shared_ptr = shared_ptr<T, single_threaded>;
+
+template <class T> using local_weak_ptr = weak_ptr<T, single_threaded>;
+
+template <class T>
+using enable_local_shared_from_this =
+    enable_shared_from_this<T, single_threaded>;
+
+template <class U, class Alloc, class... Args>
+auto allocate_local_shared(const Alloc &alloc, Args &&...args)
+    -> local_shared_ptr<U> {
+    return detail::allocate_shared_with<U, single_threaded>(
+        alloc, std::forward<Args>(args)...);
+}
+
+template <class U, class... Args>
+auto make_local_shared(Args &&...args) -> local_shared_ptr<U> {
+    return mystd::allocate_local_shared<U>(
+        std::allocator<std::remove_cv_t<std::remove_extent_t<U>>>{},
+        std::forward<Args>(args)...);
+}
+
+// ****************************************************************************
+// *                           biased_shared_ptr                              *
+// ****************************************************************************
+
+// same control blocks, the thread that creates the object copies and drops
+// its pointers without atomic read-modify-write, see `biased`
+//  - for shared objects that are mostly used by the thread that created them
+template <class T> using biased_shared_ptr = shared_ptr<T, biased>;
+
+template <class T> using biased_weak_ptr = weak_ptr<T, biased>;
+
+template <class T>
+using enable_biased_shared_from_this = enable_shared_from_this<T, biased>;
+
+template <class U, class Alloc, class... Args>
+auto allocate_biased_shared(const Alloc &alloc, Args &&...args)
+    -> biased_shared_ptr<U> {
+    return detail::allocate_shared_with<U, biased>(
+        alloc, std::forward<Args>(args)...);
+}
+
+template <class U, class... Args>
+auto make_biased_shared(Args &&...args) -> biased_shared_ptr<U> {
+    return mystd::allocate_biased_shared<U>(
+        std::allocator<std::remove_cv_t<std::remove_extent_t<U>>>{},
+        std::forward<Args>(args)...);
+}
+
 } // namespace mystd
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "concepts.hpp"
+#include "relocate.hpp"
 #include <compare>
 #include <concepts>
 #include <cstddef>
@@ -18,6 +19,10 @@ namespace detail {
 template <class From, class To>
 concept pointer_convertible_to = std::convertible_to<From *, To *>;
 
+// a Deleter of unique_ptr<T> is called with `T *`, or `U *` for T = U[]
+template <class Deleter, class T>
+concept deleter_for = std::invocable<Deleter, std::remove_extent_t<T> *>;
+
 template <class From, class To>
 concept deleter_copy_constructible_to =
     std::is_reference_v<From> && std::is_nothrow_constructible_v<To, From>;
@@ -44,19 +49,22 @@ template <class T> struct default_delete {
 
     constexpr void operator()(T *ptr) const {
         static_assert(complete<T>);
-        ::delete ptr;
+        // not ::delete, which frees the static type size of a derived object
+        delete ptr;
     }
 };
 
 template <class T> struct default_delete<T[]> {
     constexpr default_delete() noexcept = default;
 
-    template <detail::pointer_convertible_to<T> U>
-    constexpr default_delete(const default_delete<U[]> &) noexcept {}
+    // a U[] converts only if U is T less cv-qualified, a Derived[] is not a
+    // Base[]
+    template <detail::pointer_convertible_to<T[]> U>
+    constexpr default_delete(const default_delete<U> &) noexcept {}
 
     constexpr void operator()(T *ptr) const {
         static_assert(complete<T>);
-        ::delete[] ptr;
+        delete[] ptr;
     }
 };
 
@@ -66,13 +74,18 @@ template <class T> struct default_delete<T[]> {
 
 template <class T, class Deleter = default_delete<T>>
     requires(!std::is_rvalue_reference_v<Deleter>) &&
-            std::invocable<Deleter, T *>
+            detail::deleter_for<Deleter, T>
 class unique_ptr {
   public:
     using pointer = T *;
     using element_type = T;
     using deleter_type = Deleter;
 
+    // a raw pointer plus the deleter (which may be a reference)
+    using trivially_relocatable =
+        std::bool_constant<std::is_reference_v<Deleter> ||
+                           is_trivially_relocatable_v<Deleter>>;
+
     // constructors
     //  regular constructors
     constexpr unique_ptr() noexcept
@@ -199,9 +212,174 @@ class unique_ptr {
     [[no_unique_address]] deleter_type _deleter;
 };
 
+// ****************************************************************************
+// *                              unique_ptr<T[]>                             *
+// ****************************************************************************
+
+// owns an array, e.g. from `new T[n]`
+//  - `operator[]` instead of `operator*` and `operator->`
+//  - converts only from arrays of less cv-qualified T, a `Derived[]` is not
+//    a `Base[]`
+template <class T, class Deleter>
+    requires(!std::is_rvalue_reference_v<Deleter>) &&
+            detail::deleter_for<Deleter, T[]>
+class unique_ptr<T[], Deleter> {
+  public:
+    using pointer = T *;
+    using element_type = T;
+    using deleter_type = Deleter;
+
+    using trivially_relocatable =
+        std::bool_constant<std::is_reference_v<Deleter> ||
+                           is_trivially_relocatable_v<Deleter>>;
+
+    // constructors
+    //  regular constructors
+    constexpr unique_ptr() noexcept
+        requires std::is_default_constructible_v<Deleter>
+        : _ptr{nullptr}, _deleter{} {}
+    constexpr unique_ptr(std::nullptr_t) noexcept
+        requires std::is_default_constructible_v<Deleter>
+        : _ptr{nullptr}, _deleter{} {}
+    constexpr explicit unique_ptr(pointer p) noexcept
+        requires std::is_default_constructible_v<Deleter>
+        : _ptr{p}, _deleter{} {}
+
+    constexpr unique_ptr(pointer p,
+                         std::conditional_t<std::is_reference_v<Deleter> &&
+                                                (!std::is_const_v<Deleter>),
+                                            Deleter, const Deleter &>
+                             d) noexcept
+        requires std::is_nothrow_copy_constructible_v<Deleter>
+        : _ptr{p}, _deleter{d} {}
+
+    constexpr unique_ptr(pointer p, Deleter &&d) noexcept
+        requires(!std::is_reference_v<Deleter>) &&
+                    std::is_nothrow_move_constructible_v<Deleter>
+        : _ptr{p}, _deleter{std::move(d)} {}
+
+    // copy/move constructors
+    template <detail::pointer_convertible_to<T[]> U,
+              detail::deleter_copy_constructible_to<Deleter> OtherDeleter>
+    constexpr unique_ptr(unique_ptr<U, OtherDeleter> &&other) noexcept
+        : _ptr(other.release()), _deleter(other.get_deleter()) {}
+
+    template <detail::pointer_convertible_to<T[]> U,
+              detail::deleter_move_constructible_to<Deleter> OtherDeleter>
+    constexpr unique_ptr(unique_ptr<U, OtherDeleter> &&other) noexcept
+        : _ptr(other.release()), _deleter(std::move(other.get_deleter())) {}
+
+    // destructor
+    constexpr ~unique_ptr() { _deleter(_ptr); }
+
+    // assignments
+    constexpr auto operator=(std::nullptr_t) -> unique_ptr & {
+        reset();
+        return *this;
+    }
+
+    template <detail::pointer_convertible_to<T[]> U,
+              detail::deleter_copy_assignable_to<Deleter> OtherDeleter>
+    constexpr auto operator=(unique_ptr<U, OtherDeleter> &&other) noexcept
+        -> unique_ptr & {
+        if (static_cast<void *>(this) == static_cast<void *>(&other))
+            return *this; // self-move-assignment is no-op
+        reset();
+        _ptr = other.release();
+        _deleter = other.get_deleter();
+        return *this;
+    }
+
+    template <detail::pointer_convertible_to<T[]> U,
+              detail::deleter_move_assignable_to<Deleter> OtherDeleter>
+    constexpr auto operator=(unique_ptr<U, OtherDeleter> &&other) noexcept
+        -> unique_ptr & {
+        if (static_cast<void *>(this) == static_cast<void *>(&other))
+            return *this; // self-move-assignment is no-op
+        reset();
+        _ptr = other.release();
+        _deleter = std::move(other.get_deleter());
+        return *this;
+    }
+
+    // modifiers
+    constexpr auto release() noexcept -> pointer {
+        return std::exchange(_ptr, nullptr);
+    }
+    constexpr auto reset(pointer ptr = nullptr) noexcept -> void {
+        if (ptr == _ptr)
+            return; // no-op if ptr the same as _ptr
+        _deleter(std::exchange(_ptr, ptr));
+    }
+    constexpr auto swap(unique_ptr &other) noexcept -> void {
+        _ptr = std::exchange(other._ptr, _ptr);
+        _deleter = std::exchange(other._deleter, _deleter);
+    }
+
+    // observers
+    constexpr auto get() const noexcept -> pointer { return _ptr; }
+    constexpr auto get_deleter() noexcept -> deleter_type & { return _deleter; }
+    constexpr auto get_deleter() const noexcept -> const deleter_type & {
+        return _deleter;
+    }
+    constexpr explicit operator bool() const noexcept {
+        return get() != nullptr;
+    }
+
+    constexpr auto operator[](std::size_t i) const -> T & { return _ptr[i]; }
+
+    // compare
+    template <class U, class D>
+    [[nodiscard]] constexpr auto
+    operator==(const unique_ptr<U, D> &rhs) const noexcept -> bool {
+        return get() == rhs.get();
+    }
+
+    [[nodiscard]] constexpr auto operator==(std::nullptr_t) const noexcept
+        -> bool {
+        return get() == nullptr;
+    }
+
+    template <class T2, class D2>
+        requires std::three_way_comparable_with<
+                     pointer, typename unique_ptr<T2, D2>::pointer>
+    [[nodiscard]] constexpr auto
+    operator<=>(const unique_ptr<T2, D2> &rhs) const noexcept
+        -> std::compare_three_way_result_t<
+            pointer, typename unique_ptr<T2, D2>::pointer> {
+        return get() <=> rhs.get();
+    }
+
+  private:
+    pointer _ptr;
+    [[no_unique_address]] deleter_type _deleter;
+};
+
 template <class T, class... Args>
+    requires(!std::is_array_v<T>)
 constexpr auto make_unique(Args &&...args) -> unique_ptr<T> {
     return unique_ptr<T>(new T(std::forward<Args>(args)...));
 }
 
-} // namespace mystd
\ No newline at end of file
+// n value-initialized elements, e.g. zeros
+template <class T>
+    requires std::is_unbounded_array_v<T>
+constexpr auto make_unique(std::size_t n) -> unique_ptr<T> {
+    return unique_ptr<T>(new std::remove_extent_t<T>[n]());
+}
+
+// default-initialized, a trivially constructible object is left
+// uninitialized, for buffers that are written before they are read
+template <class T>
+    requires(!std::is_array_v<T>)
+constexpr auto make_unique_for_overwrite() -> unique_ptr<T> {
+    return unique_ptr<T>(new T);
+}
+
+template <class T>
+    requires std::is_unbounded_array_v<T>
+constexpr auto make_unique_for_overwrite(std::size_t n) -> unique_ptr<T> {
+    return unique_ptr<T>(new std::remove_extent_t<T>[n]);
+}
+
+} // namespace mystd
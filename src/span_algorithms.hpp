@@ -0,0 +1,538 @@
+#pragma once
+
+#include "span.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// the vectorized paths need GCC vector extensions and x86, everything else
+// uses the scalar path
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MYSTD_SPAN_ALGORITHMS_X86 1
+#else
+#define MYSTD_SPAN_ALGORITHMS_X86 0
+#endif
+
+namespace mystd {
+
+// ****************************************************************************
+// *                              simd dispatch                               *
+// ****************************************************************************
+
+namespace detail {
+
+// the instruction sets the algorithms are compiled for, chosen at runtime
+enum class simd_level { scalar, sse2, avx2 };
+
+inline auto detect_simd_level() noexcept -> simd_level {
+#if MYSTD_SPAN_ALGORITHMS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return simd_level::avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return simd_level::sse2;
+#endif
+    return simd_level::scalar;
+}
+
+// the level used by the algorithms
+//  - may be lowered to compare the levels in tests and benchmarks
+//  - zero-initialized to scalar, algorithms called during static
+//    initialization before it is detected are still correct
+inline simd_level active_simd_level = detect_simd_level();
+
+template <std::size_t Size> struct sized_int;
+
+template <> struct sized_int<1> {
+    using signed_type = std::int8_t;
+    using unsigned_type = std::uint8_t;
+};
+
+template <> struct sized_int<2> {
+    using signed_type = std::int16_t;
+    using unsigned_type = std::uint16_t;
+};
+
+template <> struct sized_int<4> {
+    using signed_type = std::int32_t;
+    using unsigned_type = std::uint32_t;
+};
+
+template <> struct sized_int<8> {
+    using signed_type = std::int64_t;
+    using unsigned_type = std::uint64_t;
+};
+
+// numbers the algorithms compute with, e.g. min and sum
+template <class T>
+concept simd_arithmetic =
+    std::is_arithmetic_v<T> && (!std::same_as<T, bool>) &&
+    (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+// values the algorithms compare with `==`, e.g. find and search
+template <class T>
+concept simd_comparable = simd_arithmetic<T> || std::same_as<T, std::byte>;
+
+// the type of a vector lane holding a T, T is bit_cast to it
+//  - integers, characters and std::byte become the fixed width integer of
+//    the same size and signedness, so that `<` compares them the same way
+template <class T> struct simd_lane {
+    using type = T;
+};
+
+template <std::integral T> struct simd_lane<T> {
+    using type =
+        std::conditional_t<std::is_signed_v<T>,
+                           typename sized_int<sizeof(T)>::signed_type,
+                           typename sized_int<sizeof(T)>::unsigned_type>;
+};
+
+template <> struct simd_lane<std::byte> {
+    using type = std::uint8_t;
+};
+
+template <class T> using simd_lane_t = typename simd_lane<T>::type;
+
+template <class T>
+using simd_unsigned_t = typename sized_int<sizeof(T)>::unsigned_type;
+
+#if MYSTD_SPAN_ALGORITHMS_X86
+
+// a vector of W bytes of T, compiled to SSE2 or AVX2 registers depending on
+// the target of the function it is used in
+template <class T, std::size_t W> struct simd_vector {
+    typedef T type __attribute__((vector_size(W)));
+};
+
+template <class T, std::size_t W>
+using simd_vector_t = typename simd_vector<T, W>::type;
+
+// a kernel has a constexpr `scalar` version, and a `simd<W>` version that is
+// only inlined into the functions below
+//  - vectors are never passed to or returned from a function by value:
+//    without AVX, 32 byte vectors are passed differently
+//  - no intrinsics, they cannot be inlined into a kernel that is not
+//    compiled for their target
+template <class Kernel, class... Args>
+[[gnu::target("avx2")]] auto run_avx2(Args... args) {
+    return Kernel::template simd<32>(args...);
+}
+
+template <class Kernel, class... Args>
+[[gnu::target("sse2")]] auto run_sse2(Args... args) {
+    return Kernel::template simd<16>(args...);
+}
+
+#endif
+
+template <class Kernel, class... Args>
+constexpr auto dispatch(Args... args) {
+    if consteval {
+        return Kernel::scalar(args...);
+    } else {
+#if MYSTD_SPAN_ALGORITHMS_X86
+        switch (active_simd_level) {
+        case simd_level::avx2:
+            return run_avx2<Kernel>(args...);
+        case simd_level::sse2:
+            return run_sse2<Kernel>(args...);
+        case simd_level::scalar:
+            break;
+        }
+#endif
+        return Kernel::scalar(args...);
+    }
+}
+
+// ****************************************************************************
+// *                                 kernels                                  *
+// ****************************************************************************
+
+// in the simd versions, V is a vector of N lanes, and M the result of
+// comparing two V, with all bits of a lane set if true
+//  - the main loop handles `unroll` vectors per iteration, with independent
+//    accumulators, then one vector at a time, then the scalar version
+//  - the inner loops over `unroll` are unrolled by pragma, so that arrays of
+//    vectors stay in registers
+//  - the scalar versions are the std algorithms
+
+#if MYSTD_SPAN_ALGORITHMS_X86
+
+inline constexpr std::size_t unroll = 4;
+
+// vectors are taken by reference, see dispatch
+template <class V>
+[[gnu::always_inline]] inline auto simd_load(V &v, const void *p) noexcept
+    -> void {
+    __builtin_memcpy(&v, p, sizeof(V));
+}
+
+// true if any lane of the comparison result m is set
+template <class M>
+[[gnu::always_inline]] inline auto simd_any(const M &m) noexcept -> bool {
+    using U = simd_vector_t<std::uint64_t, sizeof(M)>;
+    auto u = (U)m;
+    std::uint64_t any = 0;
+    for (std::size_t k = 0; k < sizeof(M) / 8; k++)
+        any |= u[k];
+    return any != 0;
+}
+
+#endif
+
+struct find_kernel {
+    template <class T>
+    static constexpr auto scalar(const T *p, std::size_t n, T value) noexcept
+        -> std::size_t {
+        return static_cast<std::size_t>(std::find(p, p + n, value) - p);
+    }
+
+#if MYSTD_SPAN_ALGORITHMS_X86
+    template <std::size_t W, class T>
+    [[gnu::always_inline]] static auto simd(const T *p, std::size_t n,
+                                            T value) noexcept -> std::size_t {
+        using V = simd_vector_t<simd_lane_t<T>, W>;
+        using M = decltype(V{} == V{});
+        constexpr std::size_t N = W / sizeof(T);
+        const V needle = V{} + std::bit_cast<simd_lane_t<T>>(value);
+        std::size_t i = 0;
+        V v;
+        // the first match of a block is found by the scalar version
+        for (; i + unroll * N <= n; i += unroll * N) {
+            M hits{};
+#pragma GCC unroll 4
+            for (std::size_t u = 0; u < unroll; u++) {
+                simd_load(v, p + i + u * N);
+                hits |= v == needle;
+            }
+            if (simd_any(hits))
+                return i + scalar(p + i, unroll * N, value);
+        }
+        for (; i + N <= n; i += N) {
+            simd_load(v, p + i);
+            if (simd_any(v == needle))
+                return i + scalar(p + i, N, value);
+        }
+        return i + scalar(p + i, n - i, value);
+    }
+#endif
+};
+
+struct count_kernel {
+    template <class T>
+    static constexpr auto scalar(const T *p, std::size_t n, T value) noexcept
+        -> std::size_t {
+        return static_cast<std::size_t>(std::count(p, p + n, value));
+    }
+
+#if MYSTD_SPAN_ALGORITHMS_X86
+    template <std::size_t W, class T>
+    [[gnu::always_inline]] static auto simd(const T *p, std::size_t n,
+                                            T value) noexcept -> std::size_t {
+        using V = simd_vector_t<simd_lane_t<T>, W>;
+        using U = simd_vector_t<simd_unsigned_t<T>, W>;
+        constexpr std::size_t N = W / sizeof(T);
+        // a lane counts up to its maximum before it is added to the total
+        constexpr std::size_t max_blocks =
+            sizeof(T) < sizeof(std::size_t)
+                ? (std::size_t{1} << (8 * sizeof(T))) - 1
+                : ~std::size_t{0};
+        const V needle = V{} + std::bit_cast<simd_lane_t<T>>(value);
+        std::size_t total = 0;
+        std::size_t i = 0;
+        V v;
+        while (n - i >= N) {
+            auto blocks = (n - i) / N < max_blocks ? (n - i) / N : max_blocks;
+            U counts{};
+            for (; blocks > 0; blocks--, i += N) {
+                simd_load(v, p + i);
+                counts -= (U)(v == needle);
+            }
+            for (std::size_t k = 0; k < N; k++)
+                total += counts[k];
+        }
+        return total + scalar(p + i, n - i, value);
+    }
+#endif
+};
+
+// the smallest element if Max is false, the largest otherwise
+template <bool Max> struct extremum_kernel {
+    template <class T>
+    static constexpr auto scalar(const T *p, std::size_t n) noexcept -> T {
+        return Max ? *std::max_element(p, p + n) : *std::min_element(p, p + n);
+    }
+
+#if MYSTD_SPAN_ALGORITHMS_X86
+    template <class T>
+    [[gnu::always_inline]] static auto pick(T a, T b) noexcept -> T {
+        if constexpr (Max)
+            return a < b ? b : a;
+        else
+            return b < a ? b : a;
+    }
+
+    template <std::size_t W, class T>
+    [[gnu::always_inline]] static auto simd(const T *p, std::size_t n) noexcept
+        -> T {
+        using L = simd_lane_t<T>;
+        using V = simd_vector_t<L, W>;
+        constexpr std::size_t N = W / sizeof(T);
+        if (n < N)
+            return scalar(p, n);
+        V result[unroll];
+        V v;
+        for (std::size_t u = 0; u < unroll; u++)
+            simd_load(result[u], p);
+        std::size_t i = 0;
+        for (; i + unroll * N <= n; i += unroll * N) {
+#pragma GCC unroll 4
+            for (std::size_t u = 0; u < unroll; u++) {
+                simd_load(v, p + i + u * N);
+                result[u] = Max ? (result[u] < v ? v : result[u])
+                                : (v < result[u] ? v : result[u]);
+            }
+        }
+        for (; i + N <= n; i += N) {
+            simd_load(v, p + i);
+            result[0] = Max ? (result[0] < v ? v : result[0])
+                            : (v < result[0] ? v : result[0]);
+        }
+        L r = result[0][0];
+        for (std::size_t u = 0; u < unroll; u++)
+            for (std::size_t k = 0; k < N; k++)
+                r = pick(r, L(result[u][k]));
+        for (; i < n; i++)
+            r = pick(r, std::bit_cast<L>(p[i]));
+        return std::bit_cast<T>(r);
+    }
+#endif
+};
+
+struct sum_kernel {
+    // integers wrap around, computed as unsigned
+    template <class T>
+    using sum_t =
+        std::conditional_t<std::is_floating_point_v<T>, T, simd_unsigned_t<T>>;
+
+    template <class T>
+    static constexpr auto scalar(const T *p, std::size_t n) noexcept -> T {
+        sum_t<T> total{};
+        for (std::size_t i = 0; i < n; i++)
+            total += static_cast<sum_t<T>>(p[i]);
+        return static_cast<T>(total);
+    }
+
+#if MYSTD_SPAN_ALGORITHMS_X86
+    template <std::size_t W, class T>
+    [[gnu::always_inline]] static auto simd(const T *p, std::size_t n) noexcept
+        -> T {
+        using V = simd_vector_t<sum_t<T>, W>;
+        constexpr std::size_t N = W / sizeof(T);
+        V totals[unroll] = {};
+        V v;
+        std::size_t i = 0;
+        for (; i + unroll * N <= n; i += unroll * N) {
+#pragma GCC unroll 4
+            for (std::size_t u = 0; u < unroll; u++) {
+                simd_load(v, p + i + u * N);
+                totals[u] += v;
+            }
+        }
+        for (; i + N <= n; i += N) {
+            simd_load(v, p + i);
+            totals[0] += v;
+        }
+        totals[0] += (totals[1] + totals[2]) + totals[3];
+        sum_t<T> total{};
+        for (std::size_t k = 0; k < N; k++)
+            total += totals[0][k];
+        return static_cast<T>(total + static_cast<sum_t<T>>(
+                                          scalar(p + i, n - i)));
+    }
+#endif
+};
+
+// the index of the first difference of a and b, or n
+struct mismatch_kernel {
+    template <class T>
+    static constexpr auto scalar(const T *a, const T *b, std::size_t n) noexcept
+        -> std::size_t {
+        return static_cast<std::size_t>(std::mismatch(a, a + n, b).first - a);
+    }
+
+#if MYSTD_SPAN_ALGORITHMS_X86
+    template <std::size_t W, class T>
+    [[gnu::always_inline]] static auto simd(const T *a, const T *b,
+                                            std::size_t n) noexcept
+        -> std::size_t {
+        using V = simd_vector_t<simd_lane_t<T>, W>;
+        using M = decltype(V{} == V{});
+        constexpr std::size_t N = W / sizeof(T);
+        std::size_t i = 0;
+        V u, v;
+        for (; i + unroll * N <= n; i += unroll * N) {
+            M differs{};
+#pragma GCC unroll 4
+            for (std::size_t k = 0; k < unroll; k++) {
+                simd_load(u, a + i + k * N);
+                simd_load(v, b + i + k * N);
+                differs |= u != v;
+            }
+            if (simd_any(differs))
+                return i + scalar(a + i, b + i, unroll * N);
+        }
+        for (; i + N <= n; i += N) {
+            simd_load(u, a + i);
+            simd_load(v, b + i);
+            if (simd_any(u != v))
+                return i + scalar(a + i, b + i, N);
+        }
+        return i + scalar(a + i, b + i, n - i);
+    }
+#endif
+};
+
+// the index of the first occurrence of the m bytes of s in the n bytes of p,
+// or n, with 0 < m <= n
+//  - the simd version compares the first and the last byte of s at N
+//    positions at once, and only compares the rest where both match
+struct search_kernel {
+    template <class T>
+    static constexpr auto scalar(const T *p, std::size_t n, const T *s,
+                                 std::size_t m) noexcept -> std::size_t {
+        return static_cast<std::size_t>(std::search(p, p + n, s, s + m) - p);
+    }
+
+#if MYSTD_SPAN_ALGORITHMS_X86
+    template <std::size_t W, class T>
+    [[gnu::always_inline]] static auto simd(const T *p, std::size_t n,
+                                            const T *s, std::size_t m) noexcept
+        -> std::size_t {
+        using V = simd_vector_t<std::uint8_t, W>;
+        constexpr std::size_t N = W;
+        const V first = V{} + std::bit_cast<std::uint8_t>(s[0]);
+        const V last = V{} + std::bit_cast<std::uint8_t>(s[m - 1]);
+        std::size_t i = 0;
+        V u, v;
+        for (; i + m - 1 + N <= n; i += N) {
+            simd_load(u, p + i);
+            simd_load(v, p + i + m - 1);
+            auto hits = (u == first) & (v == last);
+            if (!simd_any(hits))
+                continue;
+            for (std::size_t k = 0; k < N; k++)
+                if (hits[k] && std::memcmp(p + i + k, s, m) == 0)
+                    return i + k;
+        }
+        return i + scalar(p + i, n - i, s, m);
+    }
+#endif
+};
+
+} // namespace detail
+
+// ****************************************************************************
+// *                             span algorithms                              *
+// ****************************************************************************
+
+// algorithms over large columns of numbers, vectorized with SSE2 or AVX2
+// depending on the CPU, e.g. `mystd::count(span(v.data(), v.size()), 0)`
+//  - results are indices instead of iterators, s.size() if nothing is found
+//  - comparisons are `==` and `<` on the elements, so floating point -0.0
+//    equals 0.0 and NaN equals nothing
+//  - the scalar versions are used in constant evaluation
+
+template <detail::simd_comparable T, std::size_t E>
+constexpr auto find(span<T, E> s,
+                    std::type_identity_t<std::remove_const_t<T>> value) noexcept
+    -> std::size_t {
+    return detail::dispatch<detail::find_kernel>(
+        static_cast<const std::remove_const_t<T> *>(s.data()), s.size(),
+        value);
+}
+
+template <detail::simd_comparable T, std::size_t E>
+constexpr auto
+count(span<T, E> s,
+      std::type_identity_t<std::remove_const_t<T>> value) noexcept
+    -> std::size_t {
+    return detail::dispatch<detail::count_kernel>(
+        static_cast<const std::remove_const_t<T> *>(s.data()), s.size(),
+        value);
+}
+
+// s must not be empty, the result is unspecified if s contains NaN
+template <detail::simd_arithmetic T, std::size_t E>
+constexpr auto min(span<T, E> s) noexcept -> std::remove_const_t<T> {
+    assert(!s.empty());
+    return detail::dispatch<detail::extremum_kernel<false>>(
+        static_cast<const std::remove_const_t<T> *>(s.data()), s.size());
+}
+
+// s must not be empty, the result is unspecified if s contains NaN
+template <detail::simd_arithmetic T, std::size_t E>
+constexpr auto max(span<T, E> s) noexcept -> std::remove_const_t<T> {
+    assert(!s.empty());
+    return detail::dispatch<detail::extremum_kernel<true>>(
+        static_cast<const std::remove_const_t<T> *>(s.data()), s.size());
+}
+
+// integers wrap around instead of overflowing, floating point numbers are
+// added in another order than `std::accumulate`, so the rounding differs
+template <detail::simd_arithmetic T, std::size_t E>
+constexpr auto sum(span<T, E> s) noexcept -> std::remove_const_t<T> {
+    return detail::dispatch<detail::sum_kernel>(
+        static_cast<const std::remove_const_t<T> *>(s.data()), s.size());
+}
+
+// the index of the first element that differs in a and b, or the size of the
+// shorter one
+template <detail::simd_comparable T, std::size_t E1, class U, std::size_t E2>
+    requires std::same_as<std::remove_const_t<T>, std::remove_const_t<U>>
+constexpr auto mismatch(span<T, E1> a, span<U, E2> b) noexcept
+    -> std::size_t {
+    using V = std::remove_const_t<T>;
+    return detail::dispatch<detail::mismatch_kernel>(
+        static_cast<const V *>(a.data()), static_cast<const V *>(b.data()),
+        a.size() < b.size() ? a.size() : b.size());
+}
+
+template <detail::simd_comparable T, std::size_t E1, class U, std::size_t E2>
+    requires std::same_as<std::remove_const_t<T>, std::remove_const_t<U>>
+constexpr auto equal(span<T, E1> a, span<U, E2> b) noexcept -> bool {
+    if (a.size() != b.size())
+        return false;
+    // equal bits are equal values, except for floating point, memcmp is
+    // vectorized by the C library
+    if !consteval {
+        if constexpr (!std::is_floating_point_v<std::remove_const_t<T>>)
+            return a.empty() ||
+                   std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+    }
+    return mismatch(a, b) == a.size();
+}
+
+// byte search: the index of the first occurrence of needle in haystack, for
+// bytes and characters
+template <detail::simd_comparable T, std::size_t E1, class U, std::size_t E2>
+    requires(sizeof(T) == 1) &&
+            std::same_as<std::remove_const_t<T>, std::remove_const_t<U>>
+constexpr auto search(span<T, E1> haystack, span<U, E2> needle) noexcept
+    -> std::size_t {
+    using V = std::remove_const_t<T>;
+    if (needle.empty())
+        return 0;
+    if (needle.size() > haystack.size())
+        return haystack.size();
+    return detail::dispatch<detail::search_kernel>(
+        static_cast<const V *>(haystack.data()), haystack.size(),
+        static_cast<const V *>(needle.data()), needle.size());
+}
+
+} // namespace mystd
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "span.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace mystd {
+
+// ****************************************************************************
+// *                               strided_span                               *
+// ****************************************************************************
+
+// a view of every `stride`-th element from a pointer, e.g. one channel of
+// interleaved samples or one column of a row major matrix
+//  - a pointer, a size and a stride, trivially copyable like span
+//  - the stride is in elements, 0 repeats the first element
+//  - `strided(s, stride, offset)` makes one from a span or another
+//    strided_span
+template <class T> class strided_span {
+  public:
+    // member types
+    using element_type = T;
+    using size_type = std::size_t;
+    using reference = T &;
+    using pointer = T *;
+
+    // constructors
+    constexpr strided_span() noexcept = default;
+
+    constexpr strided_span(pointer first, size_type count,
+                           size_type stride) noexcept
+        : _begin{first}, _sz{count}, _stride{stride} {}
+
+    // every element of a span
+    template <std::size_t Extent>
+    constexpr strided_span(span<T, Extent> s) noexcept
+        : strided_span(s.data(), s.size(), 1) {}
+
+    // e.g. from strided_span<T> to strided_span<const T>
+    template <class U>
+        requires std::is_convertible_v<U (*)[], T (*)[]>
+    constexpr strided_span(const strided_span<U> &other) noexcept
+        : strided_span(other.data(), other.size(), other.stride()) {}
+
+    // element access
+    constexpr auto data() const noexcept -> pointer { return _begin; }
+    constexpr auto operator[](size_type idx) const noexcept -> reference {
+        return _begin[idx * _stride];
+    }
+
+    // observers
+    constexpr auto size() const noexcept -> size_type { return _sz; }
+    constexpr auto empty() const noexcept -> bool { return _sz == 0; }
+    constexpr auto stride() const noexcept -> size_type { return _stride; }
+
+    // subviews
+    constexpr auto subspan(size_type offset,
+                           size_type count = dynamic_extent) const noexcept
+        -> strided_span {
+        assert(offset <= _sz);
+        if (count == dynamic_extent)
+            count = _sz - offset;
+        assert(count <= _sz - offset);
+        return strided_span(_begin + offset * _stride, count, _stride);
+    }
+
+    constexpr auto first(size_type count) const noexcept -> strided_span {
+        return subspan(0, count);
+    }
+
+    constexpr auto last(size_type count) const noexcept -> strided_span {
+        return subspan(_sz - count, count);
+    }
+
+  private:
+    pointer _begin = nullptr;
+    size_type _sz = 0;
+    size_type _stride = 1;
+};
+
+// the elements at offset, offset + stride, offset + 2 * stride, ... of s
+//  - e.g. `strided(samples, channels, c)` is channel c of interleaved samples
+//  - empty if offset is past the end
+template <class T>
+constexpr auto strided(strided_span<T> s, std::size_t stride,
+                       std::size_t offset = 0) noexcept -> strided_span<T> {
+    assert(stride > 0);
+    if (offset >= s.size())
+        return strided_span<T>(s.data(), 0, s.stride() * stride);
+    auto count = (s.size() - offset + stride - 1) / stride;
+    return strided_span<T>(&s[offset], count, s.stride() * stride);
+}
+
+template <class T, std::size_t Extent>
+constexpr auto strided(span<T, Extent> s, std::size_t stride,
+                       std::size_t offset = 0) noexcept -> strided_span<T> {
+    return strided(strided_span<T>(s), stride, offset);
+}
+
+// ****************************************************************************
+// *                                  chunks                                  *
+// ****************************************************************************
+
+// the size of a cache line on the targets we build for
+//  - `std::hardware_destructive_interference_size` is the same value, but
+//    GCC warns about using it in a header, it may change with -mtune
+inline constexpr std::size_t cache_line_size = 64;
+
+// a span split into a fixed number of contiguous chunks, made by `chunks` or
+// `chunk_aligned`, e.g. one chunk per worker
+//  - `c[i]` is the i-th chunk as a `span<T>`, computed on access, nothing
+//    is allocated
+//  - the chunks cover the span in order, some may be empty
+//  - the chunk boundaries after a head of `_head` elements are multiples of
+//    `_unit` elements, which are distributed as evenly as possible: the
+//    sizes of the chunks, the head aside, differ by at most one unit
+template <class T> class span_chunks {
+  public:
+    using size_type = std::size_t;
+
+    constexpr span_chunks(span<T> s, size_type count, size_type head,
+                          size_type unit) noexcept
+        : _span{s}, _count{count}, _head{head < s.size() ? head : s.size()},
+          _unit{unit} {
+        assert(count > 0 && unit > 0);
+        auto units = (s.size() - _head + unit - 1) / unit;
+        _per_chunk = units / count;
+        _remainder = units % count;
+    }
+
+    constexpr auto size() const noexcept -> size_type { return _count; }
+
+    constexpr auto operator[](size_type i) const noexcept -> span<T> {
+        auto first = boundary(i);
+        return span<T>(_span.data() + first, boundary(i + 1) - first);
+    }
+
+    // enough of a forward iterator for range-for and the std algorithms
+    class iterator {
+      public:
+        using value_type = span<T>;
+        using difference_type = std::ptrdiff_t;
+
+        constexpr iterator() noexcept = default;
+        constexpr iterator(const span_chunks *chunks, size_type i) noexcept
+            : _chunks{chunks}, _i{i} {}
+
+        constexpr auto operator*() const noexcept -> span<T> {
+            return (*_chunks)[_i];
+        }
+        constexpr auto operator++() noexcept -> iterator & {
+            _i++;
+            return *this;
+        }
+        constexpr auto operator++(int) noexcept -> iterator {
+            auto old = *this;
+            _i++;
+            return old;
+        }
+        friend constexpr auto operator==(const iterator &lhs,
+                                         const iterator &rhs) noexcept
+            -> bool {
+            return lhs._i == rhs._i;
+        }
+
+      private:
+        const span_chunks *_chunks = nullptr;
+        size_type _i = 0;
+    };
+
+    constexpr auto begin() const noexcept -> iterator { return {this, 0}; }
+    constexpr auto end() const noexcept -> iterator { return {this, _count}; }
+
+  private:
+    span<T> _span;
+    size_type _count;
+    size_type _head;
+    size_type _unit;
+    size_type _per_chunk;
+    size_type _remainder;
+
+    // the first element of chunk i, the first chunks get the extra units
+    constexpr auto boundary(size_type i) const noexcept -> size_type {
+        if (i == 0)
+            return 0;
+        if (i == _count)
+            return _span.size();
+        auto units = i * _per_chunk + (i < _remainder ? i : _remainder);
+        auto b = _head + units * _unit;
+        return b < _span.size() ? b : _span.size();
+    }
+};
+
+// s split into count chunks whose sizes differ by at most one
+template <class T, std::size_t Extent>
+constexpr auto chunks(span<T, Extent> s, std::size_t count) noexcept
+    -> span_chunks<T> {
+    return span_chunks<T>(span<T>(s.data(), s.size()), count, 0, 1);
+}
+
+// s split into count chunks whose boundaries are aligned to alignment bytes,
+// so that no two chunks share a cache line and workers writing to different
+// chunks do not invalidate each other's lines
+//  - the first chunk also gets the elements before the first aligned one,
+//    the sizes of the chunks differ by less than one cache line otherwise
+//  - chunks at the end are empty if there are fewer cache lines than chunks
+//  - alignment is a power of two and a multiple of sizeof(T), the data is
+//    aligned to sizeof(T) (always true for arithmetic types)
+template <class T, std::size_t Extent>
+auto chunk_aligned(span<T, Extent> s, std::size_t count,
+                   std::size_t alignment = cache_line_size) noexcept
+    -> span_chunks<T> {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    assert(alignment % sizeof(T) == 0);
+    auto address = reinterpret_cast<std::uintptr_t>(s.data());
+    auto head_bytes = (alignment - address % alignment) % alignment;
+    assert(head_bytes % sizeof(T) == 0);
+    return span_chunks<T>(span<T>(s.data(), s.size()), count,
+                          head_bytes / sizeof(T), alignment / sizeof(T));
+}
+
+} // namespace mystd
@@ -1,39 +1,176 @@
 #pragma once
 
 #include "fixed_capacity_vector.hpp"
+#include "relocate.hpp"
+#include "scope.hpp"
 #include "small_size_optimized_vector.hpp"
 #include <algorithm>
+#include <concepts>
 #include <cstddef>
+#include <cstring>
+#include <iterator>
 #include <memory>
+#include <ranges>
 #include <type_traits>
 #include <utility>
 
 namespace mystd {
 
-template <class T> class vector {
+namespace detail {
+
+// elements may be created by memcpy only if the allocator does not customize
+// construction
+template <class Alloc, class T>
+concept default_constructing_allocator =
+    !requires(Alloc &a, T *p, const T &v) { a.construct(p, v); };
+
+// allocator extension: resize a block, possibly in place, keeping its bytes
+template <class Alloc, class T>
+concept reallocatable_allocator =
+    requires(Alloc &a, T *p, std::size_t n) {
+        { a.reallocate(p, n, n) } -> std::same_as<T *>;
+    };
+
+} // namespace detail
+
+// ****************************************************************************
+// *                            growth policies                               *
+// ****************************************************************************
+
+// `next_capacity(cap, min_cap, elem_size)` returns the capacity to grow to
+// when `cap` elements of `elem_size` bytes are not enough, the result is at
+// least `min_cap`
+
+// 1, 2, 4, 8, ...
+struct double_growth {
+    static constexpr auto next_capacity(std::size_t cap, std::size_t min_cap,
+                                        std::size_t) noexcept -> std::size_t {
+        return std::max(cap ? cap * 2 : 1, min_cap);
+    }
+};
+
+// lower peak memory, and freed blocks can eventually be reused by later
+// growth since 1.5 is less than the golden ratio
+struct one_and_half_growth {
+    static constexpr auto next_capacity(std::size_t cap, std::size_t min_cap,
+                                        std::size_t) noexcept -> std::size_t {
+        return std::max(cap + cap / 2 + 1, min_cap);
+    }
+};
+
+// 1.5x, with buffers larger than a page rounded up to whole pages so no
+// tail of the last page is wasted and mremap can extend page by page
+struct page_rounded_growth {
+    static constexpr std::size_t page_size = 4096;
+
+    static constexpr auto next_capacity(std::size_t cap, std::size_t min_cap,
+                                        std::size_t elem_size) noexcept
+        -> std::size_t {
+        auto n = one_and_half_growth::next_capacity(cap, min_cap, elem_size);
+        auto bytes = n * elem_size;
+        if (bytes < page_size)
+            return n;
+        return (bytes + page_size - 1) / page_size * page_size / elem_size;
+    }
+};
+
+// ****************************************************************************
+// *                                 vector                                   *
+// ****************************************************************************
+
+template <class T, class Allocator = std::allocator<T>,
+          class GrowthPolicy = double_growth>
+class vector {
+    using alloc_traits = std::allocator_traits<Allocator>;
+    static_assert(std::same_as<typename alloc_traits::value_type, T>);
+    static_assert(std::same_as<typename alloc_traits::pointer, T *>,
+                  "fancy pointers are not supported");
+
   public:
     // member types
     using value_type = T;
+    using allocator_type = Allocator;
     using size_type = std::size_t;
     using reference = value_type &;
     using const_reference = const value_type &;
+    using iterator = T *;
+    using const_iterator = const T *;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // owns its elements through a pointer only, so it can be moved by memcpy
+    // as long as the allocator can
+    using trivially_relocatable =
+        std::bool_constant<is_trivially_relocatable_v<Allocator>>;
 
     // constructors
-    constexpr vector() noexcept : _data{nullptr}, _sz{0}, _cap{0} {}
-    constexpr vector(const vector &other) : _sz{other._sz}, _cap{other._cap} {
-        _data = _alloc.allocate(_cap);
+    constexpr vector() noexcept(noexcept(Allocator()))
+        : _data{nullptr}, _sz{0}, _cap{0}, _alloc{} {}
+    constexpr explicit vector(const Allocator &alloc) noexcept
+        : _data{nullptr}, _sz{0}, _cap{0}, _alloc{alloc} {}
+
+    constexpr vector(const vector &other)
+        : vector(other, alloc_traits::select_on_container_copy_construction(
+                            other._alloc)) {}
+    // delegating to vector(alloc) makes *this fully constructed before any
+    // element is copied, so the destructor cleans up if a copy throws
+    constexpr vector(const vector &other, const Allocator &alloc)
+        : vector(alloc) {
+        if (other._cap > 0) {
+            _data = alloc_traits::allocate(_alloc, other._cap);
+            _cap = other._cap;
+        }
         // copy elements
-        for (size_type i = 0; i < _sz; i++)
-            std::construct_at(_data + i, *(other._data + i));
+        for (; _sz < other._sz; _sz++)
+            alloc_traits::construct(_alloc, _data + _sz, *(other._data + _sz));
     }
+
     constexpr vector(vector &&other) noexcept
         : _data{std::exchange(other._data, nullptr)},
-          _sz{std::exchange(other._sz, 0)}, _cap{std::exchange(other._cap, 0)} {
+          _sz{std::exchange(other._sz, 0)}, _cap{std::exchange(other._cap, 0)},
+          _alloc{std::move(other._alloc)} {}
+    constexpr vector(vector &&other, const Allocator &alloc) : vector(alloc) {
+        if (_alloc == other._alloc) {
+            swap_storage(other);
+            return;
+        }
+        // memory of other cannot be freed by our allocator, move elements
+        reserve(other._sz);
+        for (; _sz < other._sz; _sz++)
+            alloc_traits::construct(_alloc, _data + _sz,
+                                    std::move(*(other._data + _sz)));
+        other.clear();
     }
 
     // assignment
-    constexpr auto operator=(vector rhs) -> vector & {
-        swap(rhs);
+    // the temporary takes over the old storage together with the allocator
+    // that allocated it, so propagation is just a swap of the allocators
+    constexpr auto operator=(const vector &rhs) -> vector & {
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::
+                          value) {
+            vector tmp(rhs, rhs._alloc);
+            swap_storage(tmp);
+            std::swap(_alloc, tmp._alloc);
+        } else {
+            vector tmp(rhs, _alloc);
+            swap_storage(tmp);
+        }
+        return *this;
+    }
+
+    constexpr auto operator=(vector &&rhs) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value ||
+        alloc_traits::is_always_equal::value) -> vector & {
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                          value) {
+            vector tmp(std::move(rhs));
+            swap_storage(tmp);
+            std::swap(_alloc, tmp._alloc);
+        } else {
+            // steals the storage of rhs if the allocators are equal
+            vector tmp(std::move(rhs), _alloc);
+            swap_storage(tmp);
+        }
         return *this;
     }
 
@@ -43,9 +180,42 @@ template <class T> class vector {
         do_deallocate();
     }
 
+    // allocator
+    constexpr auto get_allocator() const noexcept -> allocator_type {
+        return _alloc;
+    }
+
     // element access
     constexpr auto data() const noexcept -> T * { return _data; }
 
+    constexpr auto begin() noexcept -> iterator { return _data; }
+    constexpr auto begin() const noexcept -> const_iterator { return _data; }
+    constexpr auto end() noexcept -> iterator { return _data + _sz; }
+    constexpr auto end() const noexcept -> const_iterator {
+        return _data + _sz;
+    }
+
+    constexpr auto cbegin() const noexcept -> const_iterator { return begin(); }
+    constexpr auto cend() const noexcept -> const_iterator { return end(); }
+    constexpr auto rbegin() noexcept -> reverse_iterator {
+        return reverse_iterator(end());
+    }
+    constexpr auto rbegin() const noexcept -> const_reverse_iterator {
+        return const_reverse_iterator(end());
+    }
+    constexpr auto rend() noexcept -> reverse_iterator {
+        return reverse_iterator(begin());
+    }
+    constexpr auto rend() const noexcept -> const_reverse_iterator {
+        return const_reverse_iterator(begin());
+    }
+    constexpr auto crbegin() const noexcept -> const_reverse_iterator {
+        return rbegin();
+    }
+    constexpr auto crend() const noexcept -> const_reverse_iterator {
+        return rend();
+    }
+
     constexpr auto operator[](size_type i) noexcept -> reference {
         return *(_data + i);
     }
@@ -62,61 +232,287 @@ template <class T> class vector {
             grow(new_cap);
     }
 
+    // value-initializes new elements
+    constexpr auto resize(size_type n) -> void {
+        if (n <= _sz) {
+            shrink_to(n);
+            return;
+        }
+        reserve(n);
+        for (; _sz < n; _sz++)
+            alloc_traits::construct(_alloc, _data + _sz);
+    }
+
+    // new elements of implicit-lifetime types are left uninitialized at
+    // runtime, so their storage can be written directly
+    //  - other types, constant evaluation and allocators with their own
+    //    `construct` value-initialize through the allocator, like resize
+    constexpr auto resize_for_overwrite(size_type n) -> void {
+        if (n <= _sz) {
+            shrink_to(n);
+            return;
+        }
+        reserve(n);
+        if (!std::is_constant_evaluated() && implicit_lifetime &&
+            detail::default_constructing_allocator<Allocator, T>) {
+            _sz = n;
+            return;
+        }
+        for (; _sz < n; _sz++)
+            alloc_traits::construct(_alloc, _data + _sz);
+    }
+
+    // grow to n uninitialized elements, call op(data(), n), and keep the
+    // first op(...) elements, e.g. to let a decoder write into the vector
+    template <class Op>
+        requires(std::is_trivially_default_constructible_v<T> &&
+                 std::is_trivially_destructible_v<T>)
+    constexpr auto resize_and_overwrite(size_type n, Op op) -> void {
+        resize_for_overwrite(n);
+        auto r = static_cast<size_type>(std::move(op)(_data, n));
+        _sz = r < n ? r : n;
+    }
+
     // modifiers
     constexpr auto clear() noexcept -> void {
         destroy_all();
         _sz = 0;
     }
 
+    // the range must not refer to elements of this vector
+    template <std::ranges::input_range R>
+        requires std::constructible_from<T, std::ranges::range_reference_t<R>>
+    constexpr auto assign_range(R &&rg) -> void {
+        clear();
+        append_range(std::forward<R>(rg));
+    }
+
+    template <std::ranges::input_range R>
+        requires std::constructible_from<T, std::ranges::range_reference_t<R>>
+    constexpr auto append_range(R &&rg) -> void {
+        if constexpr (std::ranges::forward_range<R> ||
+                      std::ranges::sized_range<R>) {
+            // a single capacity check
+            auto n = static_cast<size_type>(std::ranges::distance(rg));
+            reserve_for_append(n);
+            append_n(std::ranges::begin(rg), n);
+        } else {
+            for (auto &&elem : rg)
+                emplace_back(std::forward<decltype(elem)>(elem));
+        }
+    }
+
+    template <std::input_iterator InputIt>
+        requires std::constructible_from<T, std::iter_reference_t<InputIt>>
+    constexpr auto insert(const_iterator pos, InputIt first, InputIt last)
+        -> iterator {
+        auto idx = static_cast<size_type>(pos - _data);
+        auto old_sz = _sz;
+        if constexpr (std::forward_iterator<InputIt>) {
+            auto n = static_cast<size_type>(std::distance(first, last));
+            reserve_for_append(n);
+            if (detail::relocatable_bitwise<T>() &&
+                std::is_nothrow_constructible_v<
+                    T, std::iter_reference_t<InputIt>>) {
+                // shift the tail by memmove, then fill the gap
+                auto gap = _data + idx;
+                if (n > 0)
+                    std::memmove(static_cast<void *>(gap + n),
+                                 static_cast<const void *>(gap),
+                                 (_sz - idx) * sizeof(T));
+                _sz = idx;
+                append_n(first, n);
+                _sz = old_sz + n;
+                return gap;
+            }
+            append_n(first, n);
+        } else {
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+        // new elements were appended, rotate them into place
+        std::rotate(_data + idx, _data + old_sz, _data + _sz);
+        return _data + idx;
+    }
+
+    // swapping vectors with unequal allocators that do not propagate is
+    // undefined behavior, as in the standard
     constexpr auto swap(vector &other) noexcept -> void {
-        std::swap(_data, other._data);
-        std::swap(_sz, other._sz);
-        std::swap(_cap, other._cap);
+        swap_storage(other);
+        if constexpr (alloc_traits::propagate_on_container_swap::value)
+            std::swap(_alloc, other._alloc);
     }
 
     template <class... Args>
     constexpr auto emplace_back(Args &&...args) -> reference {
         if (_sz == _cap)
-            grow(_cap ? _cap * 2 : 1);
-        return *std::construct_at(_data + _sz++, std::forward<Args>(args)...);
+            grow(GrowthPolicy::next_capacity(_cap, _sz + 1, sizeof(T)));
+        alloc_traits::construct(_alloc, _data + _sz,
+                                std::forward<Args>(args)...);
+        return *(_data + _sz++);
     }
 
     constexpr auto pop_back() noexcept -> void {
-        std::destroy_at(_data + (--_sz));
+        alloc_traits::destroy(_alloc, _data + (--_sz));
+    }
+
+    template <class... Args>
+    constexpr auto emplace(const_iterator pos, Args &&...args) -> iterator {
+        auto idx = static_cast<size_type>(pos - _data);
+        if (idx == _sz) {
+            emplace_back(std::forward<Args>(args)...);
+            return _data + idx;
+        }
+        // args may refer to an element of this container, construct it first
+        T value(std::forward<Args>(args)...);
+        reserve_for_append(1);
+        detail::insert_one(_data + idx, _data + _sz, std::move(value),
+                           constructor());
+        ++_sz;
+        return _data + idx;
+    }
+
+    constexpr auto insert(const_iterator pos, const T &value) -> iterator {
+        return emplace(pos, value);
+    }
+
+    constexpr auto insert(const_iterator pos, T &&value) -> iterator {
+        return emplace(pos, std::move(value));
+    }
+
+    constexpr auto erase(const_iterator pos) -> iterator {
+        return erase(pos, pos + 1);
+    }
+
+    constexpr auto erase(const_iterator first, const_iterator last)
+        -> iterator {
+        auto p = _data + (first - _data);
+        auto new_end = detail::erase_range(p, _data + (last - _data),
+                                           _data + _sz, constructor());
+        _sz = static_cast<size_type>(new_end - _data);
+        return p;
+    }
+
+    // O(1) but does not keep the order: the last element is moved into pos
+    constexpr auto unordered_erase(const_iterator pos) -> iterator {
+        auto p = _data + (pos - _data);
+        auto new_end = detail::unordered_erase(p, _data + _sz, constructor());
+        _sz = static_cast<size_type>(new_end - _data);
+        return p;
+    }
+
+    template <class Pred>
+    friend constexpr auto erase_if(vector &c, Pred pred) -> size_type {
+        return detail::erase_if(c._data, c._sz, pred, c.constructor());
+    }
+
+    template <class U>
+    friend constexpr auto erase(vector &c, const U &value) -> size_type {
+        return erase_if(c, [&value](const T &elem) { return elem == value; });
     }
 
   private:
     T *_data;
     size_type _sz;
     size_type _cap;
-    [[no_unique_address]] std::allocator<T> _alloc;
+    [[no_unique_address]] Allocator _alloc;
+
+    static constexpr bool implicit_lifetime =
+        std::is_trivially_default_constructible_v<T> &&
+        std::is_trivially_destructible_v<T>;
+
+    // elements are created and destroyed through the allocator
+    constexpr auto constructor() noexcept
+        -> detail::allocator_construct<Allocator> {
+        return {_alloc};
+    }
+
+    constexpr auto swap_storage(vector &other) noexcept -> void {
+        std::swap(_data, other._data);
+        std::swap(_sz, other._sz);
+        std::swap(_cap, other._cap);
+    }
 
     // input n should be greater than capacity
     constexpr auto grow(size_type n) -> void {
-        auto new_data = _alloc.allocate(n);
+        if constexpr (detail::reallocatable_allocator<Allocator, T>) {
+            // let the allocator extend the block in place if it can
+            if (_cap > 0 && detail::relocatable_bitwise<T>()) {
+                _data = _alloc.reallocate(_data, _cap, n);
+                _cap = n;
+                return;
+            }
+        }
 
-        for (size_type i = 0; i < _sz; i++)
-            std::construct_at(new_data + i,
-                              std::move_if_noexcept(*(_data + i)));
-        destroy_all();
+        auto new_data = alloc_traits::allocate(_alloc, n);
+
+        if (detail::relocatable_bitwise<T>()) {
+            // a single memcpy, old elements need no destruction
+            uninitialized_relocate(_data, _data + _sz, new_data);
+        } else if constexpr (std::is_nothrow_move_constructible_v<T>) {
+            uninitialized_move_if_noexcept(_data, _data + _sz, new_data,
+                                           constructor());
+            destroy_all();
+        } else {
+            // if an element copy throws, free the new storage and leave *this
+            // untouched
+            scope_exit guard{
+                [&] { alloc_traits::deallocate(_alloc, new_data, n); }};
+            uninitialized_move_if_noexcept(_data, _data + _sz, new_data,
+                                           constructor());
+            guard.release();
+            destroy_all();
+        }
         do_deallocate();
 
         _data = new_data;
         _cap = n;
     }
 
-    constexpr auto destroy_all() const noexcept -> void {
+    // make room for n more elements, growing by the policy at least once
+    constexpr auto reserve_for_append(size_type n) -> void {
+        if (_sz + n > _cap)
+            grow(GrowthPolicy::next_capacity(_cap, _sz + n, sizeof(T)));
+    }
+
+    // construct n elements from first at the end, capacity must be enough
+    template <class It>
+    constexpr auto append_n(It first, size_type n) -> void {
+        if constexpr (std::contiguous_iterator<It> &&
+                      std::same_as<std::iter_value_t<It>, T> &&
+                      std::is_trivially_copyable_v<T> &&
+                      detail::default_constructing_allocator<Allocator, T>) {
+            if (!std::is_constant_evaluated()) {
+                if (n > 0)
+                    std::memcpy(
+                        static_cast<void *>(_data + _sz),
+                        static_cast<const void *>(std::to_address(first)),
+                        n * sizeof(T));
+                _sz += n;
+                return;
+            }
+        }
+        for (auto last = _sz + n; _sz < last; _sz++, ++first)
+            alloc_traits::construct(_alloc, _data + _sz, *first);
+    }
+
+    constexpr auto shrink_to(size_type n) noexcept -> void {
+        while (_sz > n)
+            alloc_traits::destroy(_alloc, _data + (--_sz));
+    }
+
+    constexpr auto destroy_all() noexcept -> void {
         if constexpr (!std::is_trivially_destructible_v<T>) {
             for (auto first = _data, last = _data + _sz; first != last;
                  first++) {
-                std::destroy_at(first);
+                alloc_traits::destroy(_alloc, first);
             }
         }
     }
 
     constexpr auto do_deallocate() -> void {
         if (_cap > 0)
-            _alloc.deallocate(_data, _cap);
+            alloc_traits::deallocate(_alloc, _data, _cap);
     }
 };
 
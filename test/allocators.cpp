@@ -0,0 +1,161 @@
+
+#include "memory.hpp"
+#include "vector.hpp"
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+using namespace mystd;
+
+auto aligned_to(const void *p, std::size_t alignment) -> bool {
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+auto test_monotonic_arena() -> void {
+    alignas(std::max_align_t) std::byte buffer[64];
+    monotonic_arena arena(buffer, sizeof buffer);
+
+    // bump allocation inside the user buffer
+    auto p1 = arena.allocate(10, 1);
+    auto p2 = arena.allocate(8, 8);
+    assert(p1 == buffer);
+    assert(aligned_to(p2, 8));
+    assert(static_cast<std::byte *>(p2) >= buffer + 10);
+
+    // only the most recent allocation can be reclaimed
+    arena.deallocate(p2, 8, 8);
+    assert(arena.allocate(8, 8) == p2);
+    arena.deallocate(p1, 10, 1);
+    assert(arena.allocate(1, 1) != p1);
+
+    // overflow to heap chunks
+    auto p3 = arena.allocate(1000, 64);
+    assert(aligned_to(p3, 64));
+    assert(p3 < buffer || p3 >= buffer + sizeof buffer);
+
+    // restart from the user buffer
+    arena.release();
+    assert(arena.allocate(10, 1) == buffer);
+
+    // the alignment padding alone is larger than the space left, the next
+    // 64 byte boundary is 16 bytes past the end
+    alignas(64) std::byte small[48];
+    monotonic_arena small_arena(small, sizeof small);
+    assert(small_arena.allocate(40, 1) == small);
+    auto p4 = static_cast<std::byte *>(small_arena.allocate(8, 64));
+    assert(aligned_to(p4, 64) && p4 != small + 64);
+    std::memset(p4, 0, 8);
+}
+
+auto test_fixed_size_pool() -> void {
+    fixed_size_pool pool(24, 4);
+    assert(pool.block_size() % alignof(std::max_align_t) == 0);
+
+    void *blocks[10];
+    for (auto &b : blocks) {
+        b = pool.allocate(24, 8);
+        assert(aligned_to(b, alignof(std::max_align_t)));
+    }
+    for (int i = 0; i < 10; i++)
+        for (int j = 0; j < i; j++)
+            assert(blocks[i] != blocks[j]);
+
+    // freed blocks are reused first
+    pool.deallocate(blocks[3], 24, 8);
+    assert(pool.allocate(24, 8) == blocks[3]);
+
+    // too large for a block
+    auto big = pool.allocate(1000, 8);
+    pool.deallocate(big, 1000, 8);
+
+    for (auto b : blocks)
+        pool.deallocate(b, 24, 8);
+}
+
+auto test_arena_vector() -> void {
+    monotonic_arena arena;
+    {
+        vector<std::string, arena_allocator<std::string>> vec(arena);
+        for (int i = 0; i < 100; i++)
+            vec.emplace_back(std::to_string(i));
+        for (int i = 0; i < 100; i++)
+            assert(vec[i] == std::to_string(i));
+
+        // copies are allocated from the same arena
+        auto vec2 = vec;
+        assert(vec2.get_allocator() == vec.get_allocator());
+        assert(vec2.size() == 100);
+
+        // rebinding keeps the arena
+        arena_allocator<int> alloc(vec.get_allocator());
+        assert(alloc.resource() == &arena);
+    }
+    arena.release();
+}
+
+auto test_pool_vector() -> void {
+    // per-request vectors of a bounded capacity
+    fixed_size_pool pool(16 * sizeof(int));
+    for (int round = 0; round < 3; round++) {
+        vector<int, pool_allocator<int>> vec(pool);
+        vec.reserve(16);
+        for (int i = 0; i < 16; i++)
+            vec.emplace_back(i);
+        assert(vec.capacity() == 16);
+        for (int i = 0; i < 16; i++)
+            assert(vec[i] == i);
+    }
+}
+
+auto test_no_propagation() -> void {
+    monotonic_arena arena1, arena2;
+    vector<int, arena_allocator<int>> vec1(arena1), vec2(arena2);
+    vec1.emplace_back(1);
+    vec2.emplace_back(2);
+    vec2.emplace_back(3);
+
+    // allocators do not propagate, elements are copied/moved into arena1
+    vec1 = vec2;
+    assert(vec1.get_allocator().resource() == &arena1);
+    assert(vec1.size() == 2 && vec1[0] == 2 && vec1[1] == 3);
+
+    vec2.emplace_back(4);
+    vec1 = std::move(vec2);
+    assert(vec1.get_allocator().resource() == &arena1);
+    assert(vec1.size() == 3 && vec1[2] == 4);
+
+    // move construction always takes the allocator along
+    auto vec3 = std::move(vec1);
+    assert(vec3.get_allocator().resource() == &arena1);
+    assert(vec1.empty());
+}
+
+auto test_malloc_allocator() -> void {
+    malloc_allocator<int> alloc;
+    constexpr auto big = malloc_allocator<int>::mmap_threshold / sizeof(int);
+
+    auto p = alloc.allocate(10);
+    for (int i = 0; i < 10; i++)
+        p[i] = i;
+
+    // realloc, then across the threshold, then mremap, then back
+    std::size_t sizes[] = {100, big * 2, big * 8, 10};
+    std::size_t n = 10;
+    for (auto new_n : sizes) {
+        p = alloc.reallocate(p, n, new_n);
+        for (int i = 0; i < 10; i++)
+            assert(p[i] == i);
+        n = new_n;
+    }
+    alloc.deallocate(p, n);
+}
+
+auto main() -> int {
+    test_monotonic_arena();
+    test_fixed_size_pool();
+    test_arena_vector();
+    test_pool_vector();
+    test_no_propagation();
+    test_malloc_allocator();
+}
@@ -1,10 +1,99 @@
 #include "any.hpp"
+#include <array>
 #include <cassert>
+#include <cstdlib>
+#include <new>
+#include <string>
 #include <vector>
 
 using namespace mystd;
 
+// counts the allocations of the whole program
+static int allocations = 0;
+
+auto operator new(std::size_t size) -> void * {
+    allocations++;
+    if (auto p = std::malloc(size))
+        return p;
+    throw std::bad_alloc{};
+}
+
+auto operator delete(void *p) noexcept -> void { std::free(p); }
+auto operator delete(void *p, std::size_t) noexcept -> void { std::free(p); }
+
+struct ThrowingMove {
+    int i = 0;
+    ThrowingMove() = default;
+    ThrowingMove(const ThrowingMove &) = default;
+    ThrowingMove(ThrowingMove &&) noexcept(false) {}
+};
+
+using Large = std::array<long, 4>;
+
+struct Counted {
+    static inline int live = 0;
+    long payload[3]{};
+    Counted() { live++; }
+    Counted(const Counted &) { live++; }
+    Counted(Counted &&) noexcept { live++; }
+    ~Counted() { live--; }
+};
+
+auto test_small_buffer() -> void {
+    static_assert(sizeof(any) == 4 * sizeof(void *));
+
+    // small values do not allocate, neither do copies and moves
+    auto before = allocations;
+    {
+        any a1 = 1;
+        any a2 = 3.14;
+        any a3 = Counted{};
+        any a4 = a1;
+        any a5 = std::move(a3);
+        assert(!a3.has_value() && Counted::live == 1);
+        a4 = a2;
+        a1.swap(a5);
+        assert(any_cast<int>(a5) == 1 && any_cast<Counted>(&a1) != nullptr);
+        a2.emplace<Counted>();
+        assert(Counted::live == 2);
+    }
+    assert(allocations == before && Counted::live == 0);
+
+    // a std::vector fits in the buffer, a libstdc++ std::string does not
+    {
+        std::vector<int> v;
+        std::string str;
+        before = allocations;
+        any a1 = std::move(v);
+        assert(allocations == before);
+        any a2 = std::move(str);
+        auto on_heap = sizeof(std::string) > 3 * sizeof(void *);
+        assert(allocations == before + (on_heap ? 1 : 0));
+    }
+    before = allocations;
+
+    // large values and values that may throw when moved are on the heap
+    {
+        any a1 = Large{1, 2, 3, 4};
+        any a2 = ThrowingMove{};
+        assert(allocations == before + 2);
+        any a3 = std::move(a1);
+        assert(allocations == before + 2);
+        assert(any_cast<Large>(a3)[3] == 4);
+        any a4 = a2;
+        assert(allocations == before + 3);
+
+        // swap between an inline and a heap value
+        any a5 = 5;
+        a5.swap(a3);
+        assert(any_cast<int>(a3) == 5);
+        assert(any_cast<Large>(a5)[0] == 1);
+    }
+}
+
 auto main() -> int {
+    test_small_buffer();
+
     // ctor
     any a1;
     any a2 = 3.14;
@@ -44,4 +133,14 @@ auto main() -> int {
     assert(any_cast<std::vector<int>>(a1).size() == 1);
     a1.reset();
     assert(!a1.has_value());
+
+    // the type is known without RTTI, cv-qualifiers are ignored
+    const any a6 = 6;
+    assert(any_cast<const int>(&a6) != nullptr);
+    assert(any_cast<long>(&a6) == nullptr);
+    assert(any_cast<int>(std::move(a4)) == 4);
+#if MYSTD_ANY_HAS_RTTI
+    assert(a6.type() == typeid(int));
+    assert(a1.type() == typeid(void));
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "memory.hpp"
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace mystd;
+
+std::atomic<int> live{0};
+
+struct Snapshot {
+    int version;
+    explicit Snapshot(int v) : version{v} { live++; }
+    ~Snapshot() { live--; }
+};
+
+static_assert(atomic_shared_ptr<Snapshot>::is_always_lock_free);
+
+auto test_basic() -> void {
+    {
+        atomic_shared_ptr<Snapshot> a;
+        assert(a.load() == nullptr);
+
+        auto sp1 = make_shared<Snapshot>(1);
+        a.store(sp1);
+        assert(a.load() == sp1);
+        assert(sp1.use_count() == 2);
+
+        auto old = a.exchange(make_shared<Snapshot>(2));
+        assert(old == sp1 && a.load()->version == 2);
+        old.reset();
+        assert(sp1.use_count() == 1);
+
+        a = nullptr;
+        assert(a.load() == nullptr && live == 1);
+
+        atomic_shared_ptr<Snapshot> b(sp1);
+        shared_ptr<Snapshot> loaded = b;
+        assert(loaded == sp1 && sp1.use_count() == 3);
+    }
+    assert(live == 0);
+    assert(count2 == 0);
+}
+
+auto test_compare_exchange() -> void {
+    {
+        auto sp1 = make_shared<Snapshot>(1);
+        auto sp2 = make_shared<Snapshot>(2);
+        atomic_shared_ptr<Snapshot> a(sp1);
+
+        auto expected = sp2;
+        assert(!a.compare_exchange_strong(expected, sp2));
+        assert(expected == sp1);
+        assert(a.compare_exchange_strong(expected, sp2));
+        assert(a.load() == sp2);
+        assert(sp1.use_count() == 2);
+
+        // same pointer but another control block is not equivalent
+        shared_ptr<Snapshot> alias(sp1, sp2.get());
+        expected = alias;
+        assert(!a.compare_exchange_strong(expected, sp1));
+        assert(expected == sp2 && expected.owner_equal(sp2));
+
+        // from and to null
+        expected = sp2;
+        assert(a.compare_exchange_strong(expected, nullptr));
+        expected = nullptr;
+        assert(a.compare_exchange_weak(expected, sp1));
+        assert(a.load() == sp1);
+    }
+    assert(live == 0);
+    assert(count2 == 0);
+}
+
+// readers load while writers publish new versions, versions seen by one
+// reader never go backwards
+auto test_concurrent() -> void {
+    {
+        atomic_shared_ptr<Snapshot> a(make_shared<Snapshot>(0));
+        constexpr int versions = 2000;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([&] {
+                int last = 0;
+                while (last < versions) {
+                    auto sp = a.load();
+                    assert(sp->version >= last);
+                    last = sp->version;
+                }
+            });
+        }
+        for (int i = 0; i < 2; i++) {
+            threads.emplace_back([&] {
+                // versions are published in order through compare_exchange
+                while (true) {
+                    auto current = a.load();
+                    if (current->version == versions)
+                        return;
+                    auto v = current->version + 1;
+                    a.compare_exchange_strong(current,
+                                              make_shared<Snapshot>(v));
+                }
+            });
+        }
+        threads.emplace_back([&] {
+            for (int i = 0; i < 200; i++) {
+                auto old = a.exchange(a.load());
+                assert(old != nullptr);
+            }
+        });
+        for (auto &t : threads)
+            t.join();
+        assert(a.load()->version == versions && live == 1);
+    }
+    assert(live == 0);
+    assert(count2 == 0);
+}
+
+// a writer stores continuously while readers load, a holder swapped out
+// while borrows of it are given back must not be freed before the last one
+auto test_store_while_loading() -> void {
+    {
+        atomic_shared_ptr<Snapshot> a(make_shared<Snapshot>(0));
+        std::atomic<bool> done{false};
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; i++) {
+            readers.emplace_back([&] {
+                while (!done.load(std::memory_order_relaxed)) {
+                    auto sp = a.load();
+                    assert(sp != nullptr && sp->version >= 0);
+                }
+            });
+        }
+        for (int v = 1; v <= 20000; v++)
+            a.store(make_shared<Snapshot>(v));
+        done = true;
+        for (auto &t : readers)
+            t.join();
+        assert(a.load()->version == 20000 && live == 1);
+    }
+    assert(live == 0);
+    assert(count2 == 0);
+}
+
+auto main() -> int {
+    test_basic();
+    test_compare_exchange();
+    test_concurrent();
+    test_store_while_loading();
+    std::cout << "pass atomic_shared_ptr test\n";
+}
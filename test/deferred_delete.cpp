@@ -0,0 +1,125 @@
+#include "memory.hpp"
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace mystd;
+
+std::atomic<int> live{0};
+
+// records where and in which order it was destroyed
+struct Big {
+    static inline std::vector<int> destroyed{};
+    static inline std::thread::id destroyed_on{};
+
+    int id;
+    explicit Big(int i) : id{i} { live++; }
+    ~Big() {
+        destroyed.push_back(id);
+        destroyed_on = std::this_thread::get_id();
+        live--;
+    }
+};
+
+auto test_shared_ptr() -> void {
+    Big::destroyed.clear();
+    {
+        shared_ptr<Big> sp1(new Big(1), deferred_delete<Big>{});
+        auto sp2 = sp1;
+        std::thread([sp = std::move(sp2)]() mutable { sp.reset(); }).join();
+        sp1.reset();
+        // not destroyed by this thread
+        reclaimer::instance().drain();
+        assert(live == 0 && Big::destroyed == std::vector<int>{1});
+        assert(Big::destroyed_on != std::this_thread::get_id());
+    }
+    assert(count2 == 0);
+
+    // from several threads, each object destroyed once
+    {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([i] {
+                for (int j = 0; j < 1000; j++) {
+                    shared_ptr<Big> sp(new Big(i), deferred_delete<Big>{});
+                    auto copy = sp;
+                }
+            });
+        }
+        for (auto &t : threads)
+            t.join();
+        reclaimer::instance().drain();
+        assert(live == 0 && Big::destroyed.size() == 4001);
+    }
+}
+
+auto test_unique_ptr() -> void {
+    Big::destroyed.clear();
+    reclaimer r;
+    {
+        unique_ptr<Big, deferred_delete<Big>> up1(new Big(1),
+                                                  deferred_delete<Big>(r));
+        unique_ptr<Big, deferred_delete<Big>> up2(nullptr,
+                                                  deferred_delete<Big>(r));
+        unique_ptr<Big[], deferred_delete<Big[]>> up3(
+            new Big[2]{Big(2), Big(3)}, deferred_delete<Big[]>(r));
+    }
+    r.drain();
+    assert(live == 0);
+    // retired in reverse order of declaration, destroyed in retire order
+    assert((Big::destroyed == std::vector<int>{3, 2, 1}));
+}
+
+auto test_reclaimer() -> void {
+    Big::destroyed.clear();
+    {
+        // objects left when the reclaimer is destroyed are not leaked
+        reclaimer r;
+        for (int i = 0; i < 100; i++)
+            r.retire(new Big(i));
+        int deleted = 0;
+        r.retire(new int{1}, [&deleted](int *p) {
+            deleted++;
+            delete p;
+        });
+        r.drain();
+        assert(live == 0 && deleted == 1);
+        for (int i = 0; i < 100; i++)
+            r.retire(new Big(i));
+    }
+    assert(live == 0 && Big::destroyed.size() == 200);
+    for (int i = 0; i < 100; i++)
+        assert(Big::destroyed[i] == i);
+}
+
+// drain returns as soon as its marker is reclaimed, the marker is on its
+// stack and is destroyed while the reclaimer thread may still be waking it
+auto test_concurrent_drain() -> void {
+    reclaimer r;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&r] {
+            for (int i = 0; i < 2000; i++) {
+                int deleted = 0;
+                r.retire(new int{i}, [&deleted](int *p) {
+                    deleted++;
+                    delete p;
+                });
+                r.drain();
+                assert(deleted == 1);
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+}
+
+auto main() -> int {
+    test_shared_ptr();
+    test_unique_ptr();
+    test_reclaimer();
+    test_concurrent_drain();
+    std::cout << "pass deferred_delete test\n";
+}
@@ -1,5 +1,8 @@
 #include "functional.hpp"
+#include <array>
+#include <cassert>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 using namespace mystd;
@@ -38,6 +41,204 @@ auto test_function_ref() -> auto{
     f2();
 }
 
+auto add_one(int x) -> int { return x + 1; }
+auto twice(int x) noexcept -> int { return 2 * x; }
+
+struct Accumulator {
+    int total = 0;
+    auto add(int x) -> int { return total += x; }
+    auto get() const noexcept -> int { return total; }
+    auto operator()(int x) -> int { return add(x); }
+    auto operator()(int x) const -> int { return total + x; }
+};
+
+// counts copies of an argument
+struct Tracked {
+    static inline int copies = 0;
+    Tracked() = default;
+    Tracked(const Tracked &) { copies++; }
+    Tracked(Tracked &&) noexcept {}
+};
+
+// non-nullable and two pointers wide
+static_assert(!std::is_default_constructible_v<function_ref<int(int)>>);
+static_assert(std::is_trivially_copyable_v<function_ref<int(int)>>);
+static_assert(sizeof(function_ref<int(int)>) == 2 * sizeof(void *));
+
+// noexcept signatures only bind noexcept callables
+static_assert(std::is_constructible_v<function_ref<int(int) noexcept>,
+                                      decltype(twice) *>);
+static_assert(!std::is_constructible_v<function_ref<int(int) noexcept>,
+                                       decltype(add_one) *>);
+static_assert(std::is_nothrow_invocable_v<function_ref<int(int) noexcept>,
+                                          int>);
+
+// a const signature only binds callables that are invocable as const
+static_assert(!std::is_constructible_v<function_ref<int() const>,
+                                       decltype([n = 0]() mutable {
+                                           return n;
+                                       }) &>);
+
+// assigning a callable would leave a dangling reference
+static_assert(!std::is_assignable_v<function_ref<int(int)> &, Accumulator>);
+
+auto test_function_ref_signatures() -> void {
+    Accumulator acc;
+
+    // non-const signature calls the non-const overload
+    function_ref<int(int)> f(acc);
+    assert(f(2) == 2 && acc.total == 2);
+
+    // const signature calls the const overload
+    function_ref<int(int) const> g(acc);
+    assert(g(5) == 7 && acc.total == 2);
+
+    function_ref<int(int) noexcept> h(twice);
+    assert(h(4) == 8);
+
+    // nontype: no callable object, a member function bound to an object,
+    // through a reference or a pointer
+    function_ref<int(int)> n(nontype<&add_one>);
+    assert(n(1) == 2);
+    function_ref<int(int)> bound(nontype<&Accumulator::add>, acc);
+    assert(bound(3) == 5 && acc.total == 5);
+    function_ref<int() const noexcept> getter(nontype<&Accumulator::get>,
+                                              &acc);
+    assert(getter() == 5);
+    function_ref deduced(nontype<&twice>);
+    static_assert(
+        std::same_as<decltype(deduced), function_ref<int(int) noexcept>>);
+
+    // rebinding from a function pointer or nontype
+    f = add_one;
+    assert(f(1) == 2);
+    f = nontype<&twice>;
+    assert(f(3) == 6);
+
+    // a non-scalar argument is copied once, by operator(), and passed by
+    // reference to the callable
+    auto by_ref = [](const Tracked &) {};
+    function_ref<void(Tracked)> t(by_ref);
+    Tracked arg;
+    t(arg);
+    assert(Tracked::copies == 1);
+
+    // the result of the callable is discarded for a void signature
+    function_ref<void(int)> discard(acc);
+    discard(1);
+    assert(acc.total == 6);
+}
+
+// counts live copies of a callable
+struct Counted {
+    static inline int live = 0;
+    int step;
+    explicit Counted(int s) : step{s} { live++; }
+    Counted(const Counted &other) : step{other.step} { live++; }
+    Counted(Counted &&other) noexcept : step{other.step} { live++; }
+    ~Counted() { live--; }
+    auto operator()(int x) -> int { return x + step; }
+};
+
+auto test_move_only_function() -> void {
+    // empty
+    move_only_function<int(int)> f;
+    assert(!f && f == nullptr);
+    bool thrown = false;
+    try {
+        f(1);
+    } catch (const bad_function_call &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // function pointer, a null one makes an empty function
+    f = add_one;
+    assert(f && f(1) == 2);
+    int (*null_fn)(int) = nullptr;
+    f = null_fn;
+    assert(!f);
+
+    // move-only capture, stored in the buffer
+    auto p = std::make_unique<int>(5);
+    move_only_function<int(int)> g = [p = std::move(p)](int x) {
+        return x + *p;
+    };
+    assert(g(1) == 6);
+    auto h = std::move(g);
+    assert(!g && h(2) == 7);
+
+    // large capture, stored on the heap
+    std::array<int, 16> big{};
+    big[15] = 10;
+    move_only_function<int(int)> large = [big](int x) { return x + big[15]; };
+    assert(large(1) == 11);
+    swap(h, large);
+    assert(h(1) == 11 && large(1) == 6);
+
+    // callables are destroyed exactly once, inline and on the heap
+    {
+        move_only_function<int(int)> small = Counted{1};
+        move_only_function<int(int), 0> heap = Counted{2};
+        assert(Counted::live == 2);
+        auto small2 = std::move(small);
+        auto heap2 = std::move(heap);
+        assert(Counted::live == 2);
+        assert(small2(1) == 2 && heap2(1) == 3);
+        small2 = nullptr;
+        assert(Counted::live == 1);
+    }
+    assert(Counted::live == 0);
+
+    // mutable state is kept between calls
+    move_only_function<int()> counter = [n = 0]() mutable { return ++n; };
+    counter();
+    assert(counter() == 2);
+}
+
+auto test_inplace_function() -> void {
+    inplace_function<int(int)> f;
+    assert(!f);
+    bool thrown = false;
+    try {
+        f(1);
+    } catch (const bad_function_call &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    f = add_one;
+    assert(f(1) == 2);
+
+    // copyable, each copy owns its callable
+    {
+        inplace_function<int(int)> g = Counted{3};
+        auto h = g;
+        assert(Counted::live == 2 && h(1) == 4);
+        h = f;
+        assert(Counted::live == 1 && h(1) == 2);
+        f = std::move(g);
+        assert(!g && Counted::live == 1 && f(1) == 4);
+        swap(f, h);
+        assert(f(1) == 2 && h(1) == 4);
+    }
+    assert(Counted::live == 0);
+
+    // the capacity is part of the type
+    std::array<long, 6> big{};
+    big[5] = 4;
+    inplace_function<long(long), sizeof(big)> large = [big](long x) {
+        return x + big[5];
+    };
+    const auto &cref = large;
+    assert(cref(1) == 5);
+    static_assert(sizeof(large) <= sizeof(big) + 2 * sizeof(void *) +
+                                       alignof(std::max_align_t));
+
+    // does not compile, the capture is larger than the capacity:
+    // inplace_function<long(long), 8> small = [big](long x) { return x; };
+}
+
 consteval auto test_reference_wrapper() -> int {
     int i = 3;
     reference_wrapper ri = i;
@@ -47,4 +248,9 @@ consteval auto test_reference_wrapper() -> int {
 
 static_assert(test_reference_wrapper() == 3);
 
-auto main() -> int { test_function_ref(); }
\ No newline at end of file
+auto main() -> int {
+    test_function_ref();
+    test_function_ref_signatures();
+    test_move_only_function();
+    test_inplace_function();
+}
\ No newline at end of file
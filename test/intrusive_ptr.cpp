@@ -0,0 +1,168 @@
+#include "memory.hpp"
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace mystd;
+
+int live = 0;
+
+struct Node : intrusive_ref_counter<Node> {
+    int value;
+    intrusive_ptr<Node> next;
+
+    explicit Node(int v, intrusive_ptr<Node> n = nullptr)
+        : value{v}, next{std::move(n)} {
+        live++;
+    }
+    Node(const Node &other)
+        : intrusive_ref_counter(other), value{other.value}, next{other.next} {
+        live++;
+    }
+    virtual ~Node() { live--; }
+};
+
+struct Leaf : Node {
+    Leaf() : Node(0) {}
+};
+
+struct LocalNode : intrusive_ref_counter<LocalNode, single_threaded> {
+    LocalNode() { live++; }
+    ~LocalNode() { live--; }
+};
+
+struct BiasedNode : intrusive_ref_counter<BiasedNode, biased> {
+    BiasedNode() { live++; }
+    BiasedNode(const BiasedNode &other) : intrusive_ref_counter(other) {
+        live++;
+    }
+    ~BiasedNode() { live--; }
+};
+
+// one pointer wide
+static_assert(sizeof(intrusive_ptr<Node>) == sizeof(Node *));
+static_assert(is_trivially_relocatable_v<intrusive_ptr<Node>>);
+
+auto test_intrusive_ptr() -> void {
+    {
+        auto head = make_intrusive<Node>(1, make_intrusive<Node>(2));
+        assert(head->use_count() == 1 && head->next->use_count() == 1);
+
+        auto copy = head;
+        intrusive_ptr<Node> moved = std::move(copy);
+        assert(copy == nullptr && head->use_count() == 2);
+
+        // a raw pointer can be turned back into an owning pointer
+        Node *raw = head.get();
+        intrusive_ptr<Node> again(raw);
+        assert(again == head && head->use_count() == 3);
+        assert(raw->intrusive_from_this() == head);
+
+        // detach and adopt keep the count unchanged
+        Node *detached = again.detach();
+        assert(again == nullptr && head->use_count() == 3);
+        intrusive_ptr<Node> adopted(detached, false);
+        assert(head->use_count() == 3);
+
+        // converted and deleted through the base
+        intrusive_ptr<Node> base = make_intrusive<Leaf>();
+        assert(live == 3);
+        base.reset();
+        assert(live == 2);
+
+        // copying an object does not copy its count
+        Node value_copy = *head;
+        assert(value_copy.use_count() == 0 && head->use_count() == 3);
+        assert(head->next->use_count() == 2);
+    }
+    assert(live == 0);
+
+    // shared ownership through a shared_ptr, holding one intrusive reference
+    {
+        auto node = make_intrusive<Node>(7);
+        shared_ptr<Node> sp(node.get(), [](Node *p) {
+            intrusive_ptr<Node> release(p, false);
+        });
+        intrusive_ptr_add_ref(node.get());
+        node.reset();
+        assert(sp->use_count() == 1 && live == 1);
+    }
+    assert(live == 0);
+}
+
+auto test_policies() -> void {
+    {
+        auto local = make_intrusive<LocalNode>();
+        auto copy = local;
+        assert(local->use_count() == 2);
+    }
+    assert(live == 0);
+
+    // atomic counts shared between threads
+    {
+        auto node = make_intrusive<Node>(1);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([node] {
+                for (int j = 0; j < 1000; j++) {
+                    auto copy = node;
+                    assert(copy->value == 1);
+                }
+            });
+        }
+        for (auto &t : threads)
+            t.join();
+        assert(node->use_count() == 1);
+    }
+    assert(live == 0);
+
+    // the last reference of a biased count dropped by another thread
+    {
+        auto node = make_intrusive<BiasedNode>();
+        std::thread([node = std::move(node)]() mutable { node.reset(); })
+            .join();
+        assert(live == 1);
+        biased::collect();
+        assert(live == 0);
+    }
+
+    // only another thread ever references the object, the reference it
+    // takes first is the one counted by the owner
+    {
+        auto raw = new BiasedNode;
+        assert(raw->use_count() == 0);
+        std::thread([raw] {
+            intrusive_ptr<BiasedNode> p(raw);
+            auto copy = p;
+            assert(raw->use_count() == 2);
+        }).join();
+        assert(live == 1);
+        biased::collect();
+        assert(live == 0);
+    }
+
+    // the same after the owner has exited, the other thread merges
+    {
+        BiasedNode *raw = nullptr;
+        std::thread([&raw] { raw = new BiasedNode; }).join();
+        intrusive_ptr<BiasedNode> p(raw);
+        assert(raw->use_count() == 1);
+        p.reset();
+        assert(live == 0);
+    }
+
+    // a copy of an object is unreferenced, as the original once was
+    {
+        auto node = make_intrusive<BiasedNode>();
+        BiasedNode value_copy = *node;
+        assert(node->use_count() == 1 && value_copy.use_count() == 0);
+    }
+    assert(live == 0);
+}
+
+auto main() -> int {
+    test_intrusive_ptr();
+    test_policies();
+    std::cout << "pass intrusive_ptr test\n";
+}
@@ -0,0 +1,150 @@
+#include "mdspan.hpp"
+#include "vector.hpp"
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+
+using namespace mystd;
+
+// static extents are not stored, as in span
+static_assert(std::is_empty_v<extents<int, 3, 4>>);
+static_assert(sizeof(extents<int, 3, dynamic_extent>) == sizeof(int));
+static_assert(sizeof(mdspan<double, extents<int, 3, 4>>) == sizeof(void *));
+static_assert(sizeof(mdspan<double, dextents<std::size_t, 2>>) ==
+              3 * sizeof(void *));
+static_assert(std::is_same_v<dextents<int, 2>,
+                             extents<int, dynamic_extent, dynamic_extent>>);
+
+consteval auto test_extents() -> bool {
+    extents<int, 2, dynamic_extent, 4> e(3);
+    static_assert(decltype(e)::rank() == 3 && decltype(e)::rank_dynamic() == 1);
+    assert(e.extent(0) == 2 && e.extent(1) == 3 && e.extent(2) == 4);
+    assert(decltype(e)::static_extent(1) == dynamic_extent);
+
+    // from all extents
+    extents<int, 2, dynamic_extent, 4> all(2, 3, 4);
+    assert(all == e);
+    assert(!(all == dextents<int, 3>(2, 5, 4)));
+    assert((all == dextents<long, 3>(2, 3, 4)));
+    return true;
+}
+
+static_assert(test_extents());
+
+consteval auto test_layouts() -> bool {
+    using E = extents<int, 2, 3, 4>;
+    E e;
+    layout_right::mapping<E> right(e);
+    layout_left::mapping<E> left(e);
+    assert(right.required_span_size() == 24 && left.required_span_size() == 24);
+    assert(right(1, 2, 3) == 1 * 12 + 2 * 4 + 3);
+    assert(left(1, 2, 3) == 1 + 2 * 2 + 3 * 6);
+    assert(right.stride(0) == 12 && right.stride(2) == 1);
+    assert(left.stride(0) == 1 && left.stride(2) == 6);
+
+    // layout_stride from a strided mapping maps the same way
+    layout_stride::mapping<E> from_right(right);
+    assert(from_right(1, 2, 3) == right(1, 2, 3));
+    assert(from_right.is_exhaustive());
+
+    // every other element of a row major 2 x 8 matrix
+    using M = extents<int, 2, 4>;
+    layout_stride::mapping<M> every_other(M{}, {8, 2});
+    assert(every_other(1, 3) == 14);
+    assert(every_other.required_span_size() == 15);
+    assert(!every_other.is_exhaustive());
+    return true;
+}
+
+static_assert(test_layouts());
+
+auto test_tiled() -> void {
+    // 5 x 7 in tiles of 2 x 4: 3 x 2 tiles, padded
+    using T = layout_tiled<2, 4>::mapping<dextents<int, 2>>;
+    T m(dextents<int, 2>(5, 7));
+    assert(m.tiles_per_row() == 2 && m.tiles_per_col() == 3);
+    assert(m.required_span_size() == 3 * 2 * 8);
+    assert(!m.is_exhaustive());
+    assert(m(0, 0) == 0 && m(0, 3) == 3 && m(1, 0) == 4);
+    assert(m(0, 4) == 8 && m(2, 0) == 16 && m(4, 6) == 42);
+
+    // unique: no two indices share an offset
+    vector<int> seen;
+    for (int k = 0; k < m.required_span_size(); k++)
+        seen.emplace_back(0);
+    for (int i = 0; i < 5; i++)
+        for (int j = 0; j < 7; j++)
+            assert(seen[static_cast<std::size_t>(m(i, j))]++ == 0);
+
+    T exact(dextents<int, 2>(4, 8));
+    assert(exact.is_exhaustive() && exact.required_span_size() == 32);
+}
+
+// the same kernel for every layout
+template <class M> auto fill(M m) -> void {
+    for (typename M::index_type i = 0; i < m.extent(0); i++)
+        for (typename M::index_type j = 0; j < m.extent(1); j++)
+            m[i, j] = static_cast<int>(10 * i + j);
+}
+
+template <class M> auto check(M m) -> void {
+    for (typename M::index_type i = 0; i < m.extent(0); i++)
+        for (typename M::index_type j = 0; j < m.extent(1); j++)
+            assert((m[i, j] == static_cast<int>(10 * i + j)));
+}
+
+auto test_mdspan() -> void {
+    vector<int> storage;
+    for (int i = 0; i < 64; i++)
+        storage.emplace_back(-1);
+
+    // CTAD from a pointer and integral extents
+    mdspan m(storage.data(), 3, 4);
+    static_assert(std::is_same_v<decltype(m),
+                                 mdspan<int, dextents<std::size_t, 2>>>);
+    assert(m.rank() == 2 && m.size() == 12 && !m.empty());
+    fill(m);
+    assert(storage[4] == 10 && storage[11] == 23);
+    check(m);
+    assert(m.is_exhaustive() && m.stride(0) == 4);
+
+    // column major over the same storage
+    mdspan<int, extents<int, 3, 4>, layout_left> col(storage.data());
+    fill(col);
+    assert(storage[1] == 10 && storage[3] == 1);
+    check(col);
+
+    // transposed view through layout_stride: rows of m are columns of t
+    using E = extents<int, 4, 3>;
+    mdspan t(storage.data(), layout_stride::mapping<E>(E{}, {1, 4}));
+    fill(m);
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 3; j++)
+            assert((t[i, j] == m[j, i]));
+
+    // tiled, over a span checked against the required size
+    span<int> s(storage.data(), storage.size());
+    mdspan tiled(s, layout_tiled<2, 2>::mapping<dextents<int, 2>>(
+                        dextents<int, 2>(5, 3)));
+    assert(tiled.mapping().required_span_size() == 24);
+    fill(tiled);
+    check(tiled);
+    assert(storage[0] == 0 && storage[1] == 1 && storage[2] == 10);
+
+    // const elements
+    mdspan<const int, extents<int, 3, 4>> view(storage.data());
+    assert((view[0, 1] == storage[1]));
+
+    // rank 0 and empty
+    mdspan<int, extents<int>> scalar(storage.data());
+    scalar[] = 7;
+    assert(storage[0] == 7 && scalar.size() == 1);
+    mdspan<int, dextents<int, 2>> empty(storage.data(), 0, 5);
+    assert(empty.empty());
+}
+
+auto main() -> int {
+    test_tiled();
+    test_mdspan();
+    std::cout << "pass mdspan test\n";
+}
@@ -0,0 +1,100 @@
+
+#include "relocate.hpp"
+#include "memory.hpp"
+#include "vector.hpp"
+#include <cassert>
+#include <string>
+
+using namespace mystd;
+
+struct Tagged {
+    using trivially_relocatable = std::true_type;
+    Tagged() {}
+    Tagged(const Tagged &) {}
+    ~Tagged() {}
+};
+
+struct Specialized {
+    Specialized() {}
+    Specialized(const Specialized &) {}
+    ~Specialized() {}
+};
+
+template <>
+struct mystd::is_trivially_relocatable<Specialized> : std::true_type {};
+
+struct SelfReferencing {
+    SelfReferencing *self = this;
+    SelfReferencing() = default;
+    SelfReferencing(const SelfReferencing &) : self{this} {}
+};
+
+struct Deleter {
+    Deleter() = default;
+    Deleter(const Deleter &) {}
+    auto operator()(int *ptr) const -> void { ::delete ptr; }
+};
+
+// detected automatically
+static_assert(is_trivially_relocatable_v<int>);
+static_assert(is_trivially_relocatable_v<int *>);
+static_assert(is_trivially_relocatable_v<double[4]>);
+
+// opt in
+static_assert(is_trivially_relocatable_v<Tagged>);
+static_assert(is_trivially_relocatable_v<Specialized>);
+static_assert(!is_trivially_relocatable_v<SelfReferencing>);
+static_assert(!is_trivially_relocatable_v<SelfReferencing[2]>);
+
+// mystd types
+static_assert(is_trivially_relocatable_v<unique_ptr<int>>);
+static_assert(is_trivially_relocatable_v<unique_ptr<int, Deleter &>>);
+static_assert(!is_trivially_relocatable_v<unique_ptr<int, Deleter>>);
+static_assert(is_trivially_relocatable_v<shared_ptr<int>>);
+static_assert(is_trivially_relocatable_v<weak_ptr<int>>);
+static_assert(is_trivially_relocatable_v<vector<SelfReferencing>>);
+static_assert(is_trivially_relocatable_v<fixed_capacity_vector<int, 4>>);
+static_assert(
+    !is_trivially_relocatable_v<fixed_capacity_vector<SelfReferencing, 4>>);
+static_assert(is_trivially_relocatable_v<small_size_optimized_vector<int, 4>>);
+static_assert(!is_trivially_relocatable_v<
+              small_size_optimized_vector<SelfReferencing, 4>>);
+
+consteval auto test_uninitialized_relocate1() -> bool {
+    std::allocator<std::string> alloc;
+    auto src = alloc.allocate(2);
+    auto dst = alloc.allocate(2);
+    std::construct_at(src, "a");
+    std::construct_at(src + 1, "b");
+
+    auto last = uninitialized_relocate(src, src + 2, dst);
+    assert(last == dst + 2);
+    assert(dst[0] == "a" && dst[1] == "b");
+
+    std::destroy(dst, last);
+    alloc.deallocate(src, 2);
+    alloc.deallocate(dst, 2);
+    return true;
+}
+
+auto test_uninitialized_relocate2() -> void {
+    std::allocator<unique_ptr<int>> alloc;
+    auto src = alloc.allocate(3);
+    auto dst = alloc.allocate(3);
+    for (int i = 0; i < 3; i++)
+        std::construct_at(src + i, make_unique<int>(i));
+
+    auto last = uninitialized_relocate(src, src + 3, dst);
+    assert(last == dst + 3);
+    for (int i = 0; i < 3; i++)
+        assert(*dst[i] == i);
+
+    std::destroy(dst, last);
+    alloc.deallocate(src, 3);
+    alloc.deallocate(dst, 3);
+}
+
+auto main() -> int {
+    static_assert(test_uninitialized_relocate1());
+    test_uninitialized_relocate2();
+}
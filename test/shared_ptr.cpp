@@ -219,6 +219,416 @@ auto test_weak_ptr() -> void {
     assert(count2 == 0);
 }
 
+// ****************************************************************************
+// *                 allocate_shared and custom deleters                      *
+// ****************************************************************************
+
+// counts the bytes currently allocated through it and its rebound copies
+template <class T> struct counting_allocator {
+    using value_type = T;
+    long *live;
+
+    explicit counting_allocator(long *l) noexcept : live{l} {}
+    template <class U>
+    counting_allocator(const counting_allocator<U> &other) noexcept
+        : live{other.live} {}
+
+    auto allocate(std::size_t n) -> T * {
+        *live += static_cast<long>(n * sizeof(T));
+        return std::allocator<T>{}.allocate(n);
+    }
+    auto deallocate(T *p, std::size_t n) noexcept -> void {
+        *live -= static_cast<long>(n * sizeof(T));
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <class U>
+    auto operator==(const counting_allocator<U> &rhs) const noexcept -> bool {
+        return live == rhs.live;
+    }
+};
+
+struct ThrowingCtor {
+    ThrowingCtor() { throw 1; }
+};
+
+auto test_allocate_shared() -> void {
+    long live = 0;
+    {
+        auto sp1 = allocate_shared<Derive>(counting_allocator<int>(&live));
+        assert(live > 0 && counts == 1);
+        weak_ptr<Derive> wp(sp1);
+        shared_ptr<Base> sp2 = sp1;
+        sp1.reset();
+        sp2.reset();
+        // the object is gone, the block is kept alive by the weak_ptr
+        assert(counts == 0 && live > 0);
+    }
+    assert(live == 0);
+    assert(count2 == 0);
+
+    // the block is freed if the constructor throws
+    try {
+        allocate_shared<ThrowingCtor>(counting_allocator<int>(&live));
+        assert(false);
+    } catch (int) {
+    }
+    assert(live == 0);
+    assert(count2 == 0);
+
+    // shared objects placed in an arena and a pool
+    {
+        monotonic_arena arena;
+        auto sp1 = allocate_shared<int>(arena_allocator<int>(arena), 1);
+        auto sp2 = allocate_shared<Derive>(arena_allocator<int>(arena));
+        assert(*sp1 == 1 && counts == 1);
+
+        fixed_size_pool pool(64);
+        for (int i = 0; i < 100; i++) {
+            auto sp3 = allocate_shared<long>(pool_allocator<long>(pool), i);
+            assert(*sp3 == i);
+        }
+    }
+    assert(counts == 0);
+    assert(count2 == 0);
+}
+
+auto test_custom_deleter() -> void {
+    long live = 0;
+    int deleted = 0;
+    {
+        auto deleter = [&deleted](Derive *p) {
+            deleted++;
+            delete p;
+        };
+        shared_ptr<Base> sp1(new Derive{}, deleter);
+        shared_ptr<Derive> sp2(new Derive{}, deleter,
+                               counting_allocator<int>(&live));
+        assert(live > 0);
+        sp2.reset(new Derive{}, deleter);
+        assert(deleted == 1 && live == 0);
+    }
+    assert(deleted == 3);
+    assert(counts == 0);
+
+    // deleter held by reference
+    {
+        struct counting_delete {
+            int n = 0;
+            auto operator()(Derive *p) -> void {
+                n++;
+                delete p;
+            }
+        } d;
+        unique_ptr<Derive, counting_delete &> up(new Derive{}, d);
+        shared_ptr<Derive> sp(std::move(up));
+        sp.reset();
+        assert(d.n == 1);
+    }
+    assert(counts == 0);
+    assert(count2 == 0);
+}
+
+// throws from the third constructor on
+struct ThrowingElement {
+    static inline int live = 0;
+    ThrowingElement() {
+        if (live == 2)
+            throw 1;
+        live++;
+    }
+    ~ThrowingElement() { live--; }
+};
+
+struct alignas(64) Aligned {
+    char c;
+};
+
+auto test_shared_ptr_array() -> void {
+    static_assert(std::is_same_v<shared_ptr<int[]>::element_type, int>);
+    static_assert(!std::is_constructible_v<shared_ptr<Base[]>, Derive *>);
+    static_assert(
+        !std::is_constructible_v<shared_ptr<Base[]>, shared_ptr<Derive[]>>);
+    static_assert(!std::is_constructible_v<shared_ptr<int>, shared_ptr<int[]>>);
+    {
+        // one allocation, value-initialized
+        auto sp1 = make_shared<int[]>(100);
+        assert(sp1[0] == 0 && sp1[99] == 0);
+        sp1[99] = 99;
+        shared_ptr<const int[]> sp2 = sp1;
+        weak_ptr<const int[]> wp = sp2;
+        assert(sp1.use_count() == 2 && wp.lock()[99] == 99);
+
+        // deleted with delete[]
+        shared_ptr<Derive[]> sp3(new Derive[3]);
+        assert(counts == 3);
+        sp3.reset(new Derive[2]);
+        assert(counts == 2);
+        shared_ptr<Derive[]> sp4(make_unique<Derive[]>(4));
+        assert(counts == 6);
+
+        auto sp5 = make_shared<Derive[]>(5);
+        assert(counts == 11);
+
+        auto sp6 = make_shared<Aligned[]>(3);
+        assert(reinterpret_cast<std::uintptr_t>(sp6.get()) % 64 == 0);
+
+        auto sp7 = make_shared_for_overwrite<double[]>(1000);
+        sp7[999] = 1.0;
+        auto sp8 = make_shared_for_overwrite<Derive>();
+        assert(counts == 12);
+    }
+    assert(counts == 0);
+    assert(count2 == 0);
+
+    // through an allocator, the elements and the block share one allocation
+    long live = 0;
+    {
+        auto sp = allocate_shared<Derive[]>(counting_allocator<int>(&live), 4);
+        assert(counts == 4);
+        assert(live >= static_cast<long>(4 * sizeof(Derive)));
+    }
+    assert(counts == 0 && live == 0);
+
+    // the constructed elements are destroyed if one throws
+    try {
+        make_shared<ThrowingElement[]>(5);
+        assert(false);
+    } catch (int) {
+    }
+    try {
+        allocate_shared<ThrowingElement[]>(counting_allocator<int>(&live), 5);
+        assert(false);
+    } catch (int) {
+    }
+    assert(ThrowingElement::live == 0 && live == 0);
+    assert(count2 == 0);
+}
+
+struct LocalESFT : enable_local_shared_from_this<LocalESFT> {
+    int value = 42;
+};
+
+// a local_shared_ptr never meets a shared_ptr
+static_assert(!std::is_constructible_v<local_shared_ptr<int>, shared_ptr<int>>);
+static_assert(!std::is_constructible_v<shared_ptr<int>, local_shared_ptr<int>>);
+static_assert(
+    detail::inherits_from_enable_shared_from_this<LocalESFT, single_threaded>);
+static_assert(!detail::inherits_from_enable_shared_from_this<LocalESFT>);
+
+auto test_local_shared_ptr() -> void {
+    {
+        auto sp1 = make_local_shared<Derive>();
+        local_shared_ptr<Base> sp2 = sp1;
+        auto sp3 = sp2;
+        assert(sp1.use_count() == 3 && counts == 1);
+
+        local_weak_ptr<Derive> wp = sp1;
+        assert(wp.lock() == sp1);
+        sp1.reset();
+        sp2.reset();
+        assert(!wp.expired());
+        sp3.reset();
+        assert(wp.expired() && wp.lock() == nullptr && counts == 0);
+    }
+    assert(count2 == 0);
+
+    // from a raw pointer, a unique_ptr and an allocator
+    {
+        local_shared_ptr<Base> sp1(new Derive);
+        local_shared_ptr<Base> sp2(make_unique<Derive>());
+        long live = 0;
+        auto sp3 =
+            allocate_local_shared<int>(counting_allocator<int>(&live), 7);
+        assert(counts == 2 && *sp3 == 7 && live > 0);
+        sp3.reset();
+        assert(live == 0);
+    }
+    assert(counts == 0);
+    assert(count2 == 0);
+
+    // enable_local_shared_from_this
+    {
+        auto sp = make_local_shared<LocalESFT>();
+        auto from_this = sp->shared_from_this();
+        assert(from_this == sp && sp.use_count() == 2);
+        assert(sp->weak_from_this().lock() == sp);
+    }
+    assert(count2 == 0);
+}
+
+struct BiasedESFT : enable_biased_shared_from_this<BiasedESFT> {
+    int value = 42;
+};
+
+// what the hook of the test below works on, it cannot capture
+struct BiasedInterleaving {
+    biased_shared_ptr<Derive> c2, c3, keep, k1, k2;
+    std::atomic<bool> handed{false};
+    std::thread owner;
+};
+
+BiasedInterleaving *interleaving = nullptr;
+biased_weak_ptr<Derive> interleaving_weak;
+std::thread locker;
+
+auto test_biased_shared_ptr() -> void {
+    // only the owner thread
+    {
+        auto sp1 = make_biased_shared<Derive>();
+        biased_shared_ptr<Base> sp2 = sp1;
+        biased_weak_ptr<Derive> wp = sp1;
+        assert(sp1.use_count() == 2 && wp.lock() == sp1);
+        sp1.reset();
+        sp2.reset();
+        assert(wp.expired() && counts == 0);
+    }
+    assert(count2 == 0);
+
+    // copied from other threads
+    {
+        auto sp = make_biased_shared<Derive>();
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([&sp] {
+                for (int j = 0; j < 1000; j++) {
+                    auto copy = sp;
+                    biased_weak_ptr<Derive> wp = copy;
+                    assert(wp.lock() == sp);
+                }
+            });
+        }
+        for (int j = 0; j < 1000; j++) {
+            auto copy = sp;
+            assert(copy.use_count() >= 2);
+        }
+        for (auto &t : threads)
+            t.join();
+        assert(sp.use_count() == 1);
+    }
+    assert(counts == 0);
+    assert(count2 == 0);
+
+    // the owner's last reference is dropped by another thread, the object is
+    // destroyed when the owner merges the counts
+    {
+        auto sp = make_biased_shared<Derive>();
+        biased_weak_ptr<Derive> wp = sp;
+        std::thread([sp = std::move(sp)]() mutable { sp.reset(); }).join();
+        assert(counts == 1 && wp.expired() && wp.lock() == nullptr);
+        biased::collect();
+        assert(counts == 0);
+    }
+    assert(count2 == 0);
+
+    // the owner thread exits first, the last reference frees the object
+    {
+        biased_shared_ptr<Derive> sp;
+        std::thread([&sp] { sp = make_biased_shared<Derive>(); }).join();
+        auto copy = sp;
+        assert(sp.use_count() == 2);
+        sp.reset();
+        copy.reset();
+        assert(counts == 0);
+    }
+    assert(count2 == 0);
+
+    // another thread queues the count, and before it pushes it, the owner
+    // merges the count through its own last decrement and exits
+    {
+        BiasedInterleaving state;
+        interleaving = &state;
+        std::atomic<bool> created{false};
+        state.owner = std::thread([&state, &created] {
+            auto sp = make_biased_shared<Derive>();
+            state.c2 = sp;
+            state.c3 = sp;
+            sp.reset();
+            created = true;
+            created.notify_one();
+            // references made by the other thread, dropped here they take
+            // the owner's count to zero
+            state.handed.wait(false);
+            state.k1.reset();
+            state.k2.reset();
+        });
+        created.wait(false);
+
+        biased_before_push = [] {
+            auto &s = *interleaving;
+            s.keep = s.c3;
+            s.k1 = s.c3;
+            s.k2 = s.c3;
+            s.c3.reset();
+            s.handed = true;
+            s.handed.notify_one();
+            s.owner.join();
+        };
+        // a reference counted by the owner takes `shared` below zero
+        state.c2.reset();
+        assert(biased_before_push == nullptr);
+        assert(counts == 1 && state.keep.use_count() == 1);
+        state.keep.reset();
+        assert(counts == 0);
+    }
+    assert(count2 == 0);
+
+    // another thread locks a weak reference while the owner merges a count
+    // queued to it: the owner's count is taken before it is added to
+    // `shared`, and lock must not mistake the object for dead in between
+    {
+        auto sp = make_biased_shared<Derive>();
+        interleaving_weak = sp;
+        auto c = sp;
+        std::thread([c = std::move(c)]() mutable { c.reset(); }).join();
+        biased_in_merge = [] {
+            locker = std::thread([] {
+                assert(interleaving_weak.lock() != nullptr);
+            });
+            std::this_thread::sleep_for(20ms);
+        };
+        biased::collect();
+        assert(biased_in_merge == nullptr);
+        locker.join();
+        interleaving_weak.reset();
+        assert(sp.use_count() == 1);
+    }
+    assert(counts == 0);
+    assert(count2 == 0);
+
+    // the same without the hook, a count is merged once, so each round
+    // locks a new object while its owner merges a count dropped by a third
+    // thread
+    for (int i = 0; i < 200; i++) {
+        auto sp = make_biased_shared<Derive>();
+        biased_weak_ptr<Derive> wp = sp;
+        auto c = sp;
+        std::thread([c = std::move(c)]() mutable { c.reset(); }).join();
+        std::atomic<bool> done{false};
+        std::thread reader([&wp, &done] {
+            do {
+                assert(wp.lock() != nullptr);
+            } while (!done.load(std::memory_order_relaxed));
+        });
+        biased::collect();
+        done = true;
+        reader.join();
+        assert(sp.use_count() == 1);
+    }
+    assert(counts == 0);
+    assert(count2 == 0);
+
+    // enable_biased_shared_from_this
+    {
+        auto sp = make_biased_shared<BiasedESFT>();
+        std::thread([&sp] {
+            assert(sp->shared_from_this() == sp);
+        }).join();
+        assert(sp.use_count() == 1);
+    }
+    assert(count2 == 0);
+}
+
 // ****************************************************************************
 // *                 enable_shared_from_this test                             *
 // ****************************************************************************
@@ -291,6 +701,11 @@ auto main() -> int {
     test_control_block();
     test_shared_ptr();
     test_weak_ptr();
+    test_allocate_shared();
+    test_custom_deleter();
+    test_shared_ptr_array();
+    test_local_shared_ptr();
+    test_biased_shared_ptr();
 
     // enable_shared_from_this
     basic_test();
@@ -0,0 +1,167 @@
+#include "span_algorithms.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace mystd;
+
+std::mt19937 rng{42};
+
+// small values, so that find and count have matches
+template <class T> auto random_column(std::size_t n) -> std::vector<T> {
+    std::uniform_int_distribution<int> dist(-20, 20);
+    std::vector<T> v(n);
+    for (auto &x : v)
+        x = static_cast<T>(dist(rng));
+    return v;
+}
+
+// every length up to a few vectors, at every offset from an aligned address,
+// against the std algorithms
+template <class T> auto test_against_std() -> void {
+    auto column = random_column<T>(300);
+    for (std::size_t offset = 0; offset < 8; offset++) {
+        for (std::size_t n = 0; n + offset <= column.size(); n += 7) {
+            const T *first = column.data() + offset;
+            const T *last = first + n;
+            span<const T> s(first, n);
+
+            for (int v : {-20, 0, 3, 21}) {
+                auto value = static_cast<T>(v);
+                auto found = std::find(first, last, value);
+                auto counted = std::count(first, last, value);
+                assert(find(s, value) ==
+                       static_cast<std::size_t>(found - first));
+                assert(count(s, value) == static_cast<std::size_t>(counted));
+            }
+            if (n > 0) {
+                assert(min(s) == *std::min_element(first, last));
+                assert(max(s) == *std::max_element(first, last));
+            }
+            // small integers, the sum is exact for floating point too
+            assert(sum(s) == std::accumulate(first, last, T{},
+                                             [](T a, T b) -> T {
+                                                 return static_cast<T>(a + b);
+                                             }));
+
+            std::vector<T> copy(first, last);
+            span<T> c(copy.data(), copy.size());
+            assert(equal(s, c) && mismatch(s, c) == n);
+            if (n > 0) {
+                auto at = n / 2;
+                copy[at] = static_cast<T>(copy[at] + 1);
+                assert(!equal(s, c) && mismatch(s, c) == at);
+                copy[n - 1] = static_cast<T>(copy[n - 1] + 1);
+                assert(mismatch(s, c) == at);
+                assert(!equal(s, c.first(n - 1)));
+                assert(mismatch(s.first(at), c) == at);
+            }
+        }
+    }
+}
+
+auto test_extremes() -> void {
+    // min and max at the ends of a column, and in the tail
+    std::vector<std::int8_t> v(100, 0);
+    v[0] = -128;
+    v[99] = 127;
+    span<const std::int8_t> s(v.data(), v.size());
+    assert(min(s) == -128 && max(s) == 127);
+
+    // unsigned lanes compare as unsigned
+    std::vector<std::uint32_t> u(40, 1);
+    u[17] = 0xffffffff;
+    span<std::uint32_t> su(u.data(), u.size());
+    assert(max(su) == 0xffffffff && min(su) == 1);
+
+    // count does not overflow narrow lanes
+    std::vector<std::uint8_t> bytes(100000, 7);
+    span<std::uint8_t> sb(bytes.data(), bytes.size());
+    assert(count(sb, 7) == bytes.size());
+    assert(sum(sb) == static_cast<std::uint8_t>(7 * bytes.size()));
+
+    // floating point comparisons
+    std::vector<double> d(50, 1.0);
+    d[20] = -0.0;
+    span<const double> sd(d.data(), d.size());
+    assert(find(sd, 0.0) == 20 && count(sd, 0.0) == 1);
+    std::vector<double> e(d);
+    e[30] = std::numeric_limits<double>::quiet_NaN();
+    d[30] = e[30];
+    assert(mismatch(sd, span<double>(e.data(), e.size())) == 30);
+}
+
+auto test_search() -> void {
+    std::string_view text = "the quick brown fox jumps over the lazy dog, "
+                            "the quick brown fox jumps over the lazy cat";
+    span<const char> haystack(text.data(), text.size());
+    for (std::size_t pos = 0; pos < text.size(); pos += 3) {
+        for (std::size_t len = 1; pos + len <= text.size(); len += 5) {
+            auto needle = text.substr(pos, len);
+            assert(search(haystack, span<const char>(needle.data(),
+                                                     needle.size())) ==
+                   text.find(needle));
+        }
+    }
+    std::string_view missing = "lazy cow";
+    assert(search(haystack, span<const char>(missing.data(),
+                                             missing.size())) == text.size());
+    assert(search(haystack, span<const char>()) == 0);
+    assert(search(haystack.first(3), haystack) == 3);
+
+    // std::byte
+    std::vector<std::byte> bytes(200, std::byte{1});
+    bytes[150] = std::byte{2};
+    bytes[151] = std::byte{3};
+    std::byte pattern[] = {std::byte{2}, std::byte{3}};
+    span<std::byte> sb(bytes.data(), bytes.size());
+    assert(search(sb, span<std::byte>(pattern, 2)) == 150);
+    assert(find(sb, std::byte{3}) == 151);
+}
+
+consteval auto test_constant_evaluation() -> bool {
+    int v[] = {5, 3, 9, 3, 7};
+    span<const int> s(v, 5);
+    assert(find(s, 9) == 2 && count(s, 3) == 2);
+    assert(min(s) == 3 && max(s) == 9 && sum(s) == 27);
+    assert(equal(s, s) && mismatch(s, s.first(3)) == 3);
+    char text[] = {'a', 'b', 'c', 'b', 'c'};
+    char needle[] = {'b', 'c'};
+    assert(search(span<const char>(text, 5), span<const char>(needle, 2)) ==
+           1);
+    return true;
+}
+
+static_assert(test_constant_evaluation());
+
+auto main() -> int {
+    // every level the machine supports, the best one last
+    auto best = detail::active_simd_level;
+    for (auto level : {detail::simd_level::scalar, detail::simd_level::sse2,
+                       detail::simd_level::avx2}) {
+        if (level > best)
+            break;
+        detail::active_simd_level = level;
+        test_against_std<std::int8_t>();
+        test_against_std<std::uint8_t>();
+        test_against_std<char>();
+        test_against_std<std::int16_t>();
+        test_against_std<std::uint16_t>();
+        test_against_std<int>();
+        test_against_std<std::uint32_t>();
+        test_against_std<std::int64_t>();
+        test_against_std<std::uint64_t>();
+        test_against_std<float>();
+        test_against_std<double>();
+        test_extremes();
+        test_search();
+    }
+    std::cout << "pass span_algorithms test\n";
+}
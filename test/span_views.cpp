@@ -0,0 +1,180 @@
+#include "span_views.hpp"
+#include "vector.hpp"
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+using namespace mystd;
+
+static_assert(std::is_trivially_copyable_v<strided_span<int>>);
+static_assert(std::forward_iterator<span_chunks<int>::iterator>);
+
+consteval auto test_strided_span() -> bool {
+    // 4 rows of 3 interleaved channels
+    int data[12];
+    for (int i = 0; i < 12; i++)
+        data[i] = i;
+    span<int, 12> s{data, 12};
+
+    strided_span<int> empty;
+    assert(empty.empty() && empty.size() == 0 && empty.stride() == 1);
+
+    // every element
+    strided_span<int> all = s;
+    assert(all.size() == 12 && all.stride() == 1);
+    assert(all[5] == 5);
+
+    // a channel
+    auto green = strided(s, 3, 1);
+    assert(green.size() == 4 && green.stride() == 3);
+    for (std::size_t i = 0; i < green.size(); i++)
+        assert(green[i] == static_cast<int>(3 * i + 1));
+
+    // written through
+    green[2] = -1;
+    assert(data[7] == -1);
+    data[7] = 7;
+
+    // the size rounds up when the last stride is partial
+    assert(strided(s, 5).size() == 3);
+    assert(strided(s, 5, 2).size() == 2);
+    assert(strided(s, 12, 11).size() == 1);
+    assert(strided(s, 3, 12).empty());
+
+    // a strided view of a strided view multiplies the strides
+    auto every_other = strided(green, 2, 1);
+    assert(every_other.size() == 2 && every_other.stride() == 6);
+    assert(every_other[0] == 4 && every_other[1] == 10);
+
+    // subviews
+    auto mid = green.subspan(1, 2);
+    assert(mid.size() == 2 && mid[0] == 4 && mid[1] == 7);
+    assert(green.subspan(1).size() == 3);
+    assert(green.first(2)[1] == 4);
+    assert(green.last(1)[0] == 10);
+
+    // to const, and a stride of 0 repeats the first element
+    strided_span<const int> c = green;
+    assert(c[3] == 10);
+    strided_span<const int> repeated{data + 2, 5, 0};
+    for (std::size_t i = 0; i < repeated.size(); i++)
+        assert(repeated[i] == 2);
+
+    return true;
+}
+
+// the chunks cover s in order, without gaps
+template <class T>
+constexpr auto covers(const span_chunks<T> &c, span<T> s) -> bool {
+    auto next = s.data();
+    for (auto chunk : c) {
+        if (chunk.data() != next)
+            return false;
+        next += chunk.size();
+    }
+    return next == s.data() + s.size();
+}
+
+consteval auto test_chunks() -> bool {
+    int data[10]{};
+    span<int> s{data, 10};
+
+    // 10 = 4 + 3 + 3
+    auto c = chunks(s, 3);
+    assert(c.size() == 3);
+    assert(c[0].size() == 4 && c[1].size() == 3 && c[2].size() == 3);
+    assert(c[0].data() == data && c[1].data() == data + 4);
+    assert(covers(c, s));
+
+    // one chunk
+    assert(chunks(s, 1)[0].size() == 10);
+
+    // more chunks than elements, the last ones are empty
+    auto many = chunks(s, 12);
+    assert(many.size() == 12);
+    for (std::size_t i = 0; i < 12; i++)
+        assert(many[i].size() == (i < 10 ? 1u : 0u));
+    assert(covers(many, s));
+
+    // of an empty span
+    auto none = chunks(span<int>{}, 4);
+    for (auto chunk : none)
+        assert(chunk.empty());
+
+    // iterators
+    auto it = c.begin();
+    assert((*it).size() == 4);
+    assert((*++it).size() == 3);
+    assert((*it++).size() == 3);
+    assert(++it == c.end());
+    return true;
+}
+
+auto is_aligned(const void *p, std::size_t alignment) -> bool {
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+auto test_chunk_aligned() -> void {
+    alignas(cache_line_size) static std::int32_t data[1024];
+    constexpr std::size_t line = cache_line_size / sizeof(std::int32_t);
+
+    // aligned data, 64 cache lines in 4 chunks of 16
+    {
+        span<std::int32_t> s{data, 1024};
+        auto c = chunk_aligned(s, 4);
+        for (auto chunk : c) {
+            assert(chunk.size() == 16 * line);
+            assert(is_aligned(chunk.data(), cache_line_size));
+        }
+        assert(covers(c, s));
+    }
+
+    // unaligned start and end
+    //  - 3 elements before the first line, 62 lines and 5 elements after
+    {
+        span<std::int32_t> s{data + line - 3, 3 + 62 * line + 5};
+        auto c = chunk_aligned(s, 4);
+        assert(covers(c, s));
+        for (std::size_t i = 1; i < c.size(); i++)
+            assert(is_aligned(c[i].data(), cache_line_size));
+        // 63 partial or whole lines after the head, 16 + 16 + 16 + 15
+        assert(c[0].size() == 3 + 16 * line);
+        assert(c[3].size() == 14 * line + 5);
+    }
+
+    // fewer lines than chunks, the last ones are empty
+    {
+        span<std::int32_t> s{data, 2 * line};
+        auto c = chunk_aligned(s, 4);
+        assert(c[0].size() == line && c[1].size() == line);
+        assert(c[2].empty() && c[3].empty());
+        assert(covers(c, s));
+    }
+
+    // shorter than the head
+    {
+        span<std::int32_t> s{data + 1, 4};
+        auto c = chunk_aligned(s, 2);
+        assert(c[0].size() == 4 && c[1].empty());
+    }
+
+    // another alignment, e.g. pages of 4 KiB in a larger buffer
+    {
+        vector<double> v;
+        for (int i = 0; i < 5000; i++)
+            v.emplace_back(i);
+        span<double> s{v.data(), v.size()};
+        auto c = chunk_aligned(s, 3, 4096);
+        assert(covers(c, s));
+        for (std::size_t i = 1; i < c.size(); i++)
+            if (!c[i].empty())
+                assert(is_aligned(c[i].data(), 4096));
+    }
+}
+
+auto main() -> int {
+    static_assert(test_strided_span());
+    static_assert(test_chunks());
+    test_chunk_aligned();
+}
@@ -137,9 +137,51 @@ auto test_unique_ptr2() -> void {
     assert(*ptr5 == 5);
 }
 
+consteval auto test_unique_ptr_array1() -> bool {
+    static_assert(sizeof(unique_ptr<int[]>) == sizeof(void *));
+    static_assert(std::is_same_v<unique_ptr<int[]>::element_type, int>);
+    static_assert(!std::is_constructible_v<unique_ptr<Base[]>,
+                                           unique_ptr<Derived[]> &&>);
+    static_assert(
+        !std::is_constructible_v<unique_ptr<Base>, unique_ptr<Derived[]> &&>);
+
+    // value-initialized
+    auto ptr1 = make_unique<int[]>(3);
+    assert(ptr1[0] == 0 && ptr1[2] == 0);
+    ptr1[1] = 1;
+
+    // to a more cv-qualified element
+    unique_ptr<const int[]> ptr2(std::move(ptr1));
+    assert(!static_cast<bool>(ptr1));
+    assert(ptr2[1] == 1);
+
+    auto ptr3 = make_unique_for_overwrite<int[]>(2);
+    ptr3[0] = 3;
+    ptr3.reset(new int[4]{1, 2, 3, 4});
+    assert(ptr3[3] == 4);
+    ptr3 = nullptr;
+    assert(ptr3 == nullptr);
+
+    auto ptr4 = make_unique_for_overwrite<int>();
+    *ptr4 = 4;
+    return true;
+}
+
+auto test_unique_ptr_array2() -> void {
+    std::cout << "test unique_ptr<T[]>:\n";
+    unique_ptr<S[]> ptr1(new S[2]);
+    ptr1.reset();
+
+    // polymorphic objects are freed with their own size
+    unique_ptr<Base> ptr2(new Derived{});
+    ptr2.reset();
+}
+
 auto main() -> int {
     test_default_delete1();
     static_assert(test_default_delete2());
     static_assert(test_unique_ptr1());
     test_unique_ptr2();
+    static_assert(test_unique_ptr_array1());
+    test_unique_ptr_array2();
 }
\ No newline at end of file
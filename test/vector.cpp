@@ -1,7 +1,13 @@
 
 #include "vector.hpp"
+#include "memory.hpp"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <ranges>
+#include <string>
+#include <vector>
 using namespace mystd;
 
 struct S {
@@ -64,6 +70,479 @@ auto test_vector2() -> void {
     vec.emplace_back(std::move(s1));
 }
 
+auto test_vector3() -> void {
+    // trivially relocatable elements are moved by memcpy when growing
+    vector<unique_ptr<int>> vec1;
+    vector<shared_ptr<int>> vec2;
+    for (int i = 0; i < 100; i++) {
+        vec1.emplace_back(make_unique<int>(i));
+        vec2.emplace_back(make_shared<int>(i));
+    }
+    auto sp = vec2[50];
+    vec2.reserve(1000);
+    for (int i = 0; i < 100; i++) {
+        assert(*vec1[i] == i);
+        assert(*vec2[i] == i);
+    }
+    assert(sp.use_count() == 2);
+}
+
+// stateful allocator that propagates on every operation
+template <class T> struct tagged_allocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    int tag;
+
+    constexpr tagged_allocator(int t) noexcept : tag{t} {}
+    template <class U>
+    constexpr tagged_allocator(const tagged_allocator<U> &other) noexcept
+        : tag{other.tag} {}
+
+    constexpr auto allocate(std::size_t n) -> T * {
+        return std::allocator<T>{}.allocate(n);
+    }
+    constexpr auto deallocate(T *p, std::size_t n) -> void {
+        std::allocator<T>{}.deallocate(p, n);
+    }
+    constexpr auto operator==(const tagged_allocator &) const noexcept
+        -> bool = default;
+};
+
+consteval auto test_vector4() -> bool {
+    using vec_t = vector<int, tagged_allocator<int>>;
+    vec_t vec1(tagged_allocator<int>{1});
+    vec_t vec2(tagged_allocator<int>{2});
+    vec1.emplace_back(1);
+    vec2.emplace_back(2);
+
+    vec1 = vec2;
+    assert(vec1.get_allocator().tag == 2);
+    assert(vec1[0] == 2);
+
+    vec_t vec3(tagged_allocator<int>{3});
+    vec3.emplace_back(3);
+    vec1 = std::move(vec3);
+    assert(vec1.get_allocator().tag == 3);
+    assert(vec1[0] == 3);
+
+    vec1.swap(vec2);
+    assert(vec1.get_allocator().tag == 2);
+    assert(vec2.get_allocator().tag == 3);
+    assert(vec1[0] == 2 && vec2[0] == 3);
+
+    vec_t vec4(vec2, tagged_allocator<int>{4});
+    assert(vec4.get_allocator().tag == 4);
+    assert(vec4[0] == 3);
+    return true;
+}
+
+consteval auto test_vector5() -> bool {
+    // growth policies
+    vector<int, std::allocator<int>, one_and_half_growth> vec1;
+    vector<char, std::allocator<char>, page_rounded_growth> vec2;
+    std::size_t caps1[] = {1, 2, 4, 7, 11};
+    for (auto cap : caps1) {
+        while (vec1.size() < vec1.capacity())
+            vec1.emplace_back(0);
+        vec1.emplace_back(1);
+        assert(vec1.capacity() == cap);
+    }
+
+    for (int i = 0; i < 5000; i++)
+        vec2.emplace_back('a');
+    assert(vec2.capacity() % page_rounded_growth::page_size == 0);
+
+    static_assert(page_rounded_growth::next_capacity(1000, 1001, 8) == 1536);
+    static_assert(double_growth::next_capacity(0, 10, 4) == 10);
+    return true;
+}
+
+auto test_vector6() -> void {
+    // realloc and mremap through malloc_allocator
+    vector<long, malloc_allocator<long>> vec1;
+    for (long i = 0; i < (1 << 22); i++)
+        vec1.emplace_back(i);
+    for (long i = 0; i < (1 << 22); i++)
+        assert(vec1[i] == i);
+
+    vector<unique_ptr<int>, malloc_allocator<unique_ptr<int>>> vec2;
+    for (int i = 0; i < 1000; i++)
+        vec2.emplace_back(make_unique<int>(i));
+    auto vec3 = std::move(vec2);
+    for (int i = 0; i < 1000; i++)
+        assert(*vec3[i] == i);
+}
+
+consteval auto test_vector7() -> bool {
+    int src[] = {0, 1, 2, 3, 4};
+    vector<int> vec;
+    vec.append_range(src);
+    assert(vec.size() == 5);
+    assert(vec.capacity() == 5);
+
+    // insert in the middle, at the end and at the front
+    vec.insert(vec.begin() + 2, src, src + 2);
+    vec.insert(vec.end(), src + 4, src + 5);
+    auto it = vec.insert(vec.begin(), src + 3, src + 5);
+    assert(it == vec.begin());
+    int expected[] = {3, 4, 0, 1, 0, 1, 2, 3, 4, 4};
+    assert(std::ranges::equal(vec, expected));
+
+    // non-forward ranges
+    vec.assign_range(std::views::iota(0, 3) |
+                     std::views::filter([](int i) { return i != 1; }));
+    assert(vec.size() == 2 && vec[0] == 0 && vec[1] == 2);
+
+    vec.resize(4);
+    assert(vec.size() == 4 && vec[3] == 0);
+    vec.resize(1);
+    assert(vec.size() == 1 && vec[0] == 0);
+
+    // elements that are not trivially copyable are shifted one by one
+    vector<std::vector<int>> nested;
+    nested.emplace_back(1, 1);
+    nested.emplace_back(1, 4);
+    std::vector<int> middle[] = {{2}, {3}};
+    nested.insert(nested.begin() + 1, middle, middle + 2);
+    assert(nested.size() == 4);
+    for (int i = 0; i < 4; i++)
+        assert(nested[i] == std::vector<int>{i + 1});
+    return true;
+}
+
+auto test_vector8() -> void {
+    // the same with elements that own memory
+    std::string letters[] = {"a", "b", "c"};
+    vector<std::string> strs;
+    strs.append_range(letters);
+    strs.insert(strs.begin() + 1, letters + 1, letters + 3);
+    std::string expected_strs[] = {"a", "b", "c", "b", "c"};
+    assert(std::ranges::equal(strs, expected_strs));
+    auto xs = [](int i) { return std::string(i, 'x'); };
+    strs.assign_range(std::views::iota(1, 4) | std::views::transform(xs));
+    assert(strs.size() == 3 && strs[2] == "xxx");
+    strs.resize(5);
+    assert(strs.size() == 5 && strs[4].empty());
+
+    // decoder writes directly into the storage
+    vector<char> buf;
+    buf.resize_and_overwrite(16, [](char *p, std::size_t n) {
+        std::memcpy(p, "hello", 5);
+        assert(n == 16);
+        return 5;
+    });
+    assert(buf.size() == 5 && buf[4] == 'o');
+
+    // trivially relocatable elements are shifted by memmove
+    vector<unique_ptr<int>> ptrs;
+    unique_ptr<int> src[] = {make_unique<int>(1), make_unique<int>(2)};
+    for (int i = 0; i < 4; i++)
+        ptrs.emplace_back(make_unique<int>(i * 10));
+    ptrs.insert(ptrs.begin() + 1, std::make_move_iterator(src),
+                std::make_move_iterator(src + 2));
+    int expected[] = {0, 1, 2, 10, 20, 30};
+    assert(ptrs.size() == 6);
+    for (int i = 0; i < 6; i++)
+        assert(*ptrs[i] == expected[i]);
+
+    buf.resize_for_overwrite(100);
+    assert(buf.size() == 100);
+    assert(buf[0] == 'h');
+}
+
+// counts the elements it constructs and destroys, e.g. what a
+// scoped_allocator_adaptor would see
+template <class T> struct constructing_allocator {
+    using value_type = T;
+
+    static inline long live = 0;
+
+    constructing_allocator() = default;
+    template <class U>
+    constructing_allocator(const constructing_allocator<U> &) noexcept {}
+
+    auto allocate(std::size_t n) -> T * {
+        return std::allocator<T>{}.allocate(n);
+    }
+    auto deallocate(T *p, std::size_t n) -> void {
+        std::allocator<T>{}.deallocate(p, n);
+    }
+    template <class... Args> auto construct(T *p, Args &&...args) -> void {
+        std::construct_at(p, std::forward<Args>(args)...);
+        live++;
+    }
+    auto destroy(T *p) -> void {
+        std::destroy_at(p);
+        live--;
+    }
+    auto operator==(const constructing_allocator &) const noexcept
+        -> bool = default;
+};
+
+// its move constructor may throw, so grow copies it
+struct ThrowingMove {
+    std::string s;
+    ThrowingMove(const char *str) : s{str} {}
+    ThrowingMove(const ThrowingMove &) = default;
+    ThrowingMove(ThrowingMove &&other) : s{std::move(other.s)} {}
+    auto operator=(const ThrowingMove &) -> ThrowingMove & = default;
+    auto operator=(ThrowingMove &&) -> ThrowingMove & = default;
+};
+
+// every element is created and destroyed through the allocator
+template <class T> auto constructs_through_allocator() -> void {
+    using alloc = constructing_allocator<T>;
+    {
+        vector<T, alloc> vec;
+        for (int i = 0; i < 100; i++) {
+            vec.emplace_back("element");
+            assert(alloc::live == static_cast<long>(vec.size()));
+        }
+        vec.insert(vec.begin() + 1, T("inserted"));
+        vec.emplace(vec.begin(), "emplaced");
+        assert(alloc::live == 102);
+        vec.erase(vec.begin() + 10, vec.begin() + 20);
+        vec.unordered_erase(vec.begin());
+        assert(alloc::live == 91);
+        erase_if(vec, [](const T &) { return true; });
+        assert(alloc::live == 0 && vec.empty());
+        vec.emplace_back("element");
+    }
+    assert(alloc::live == 0);
+}
+
+auto test_vector9() -> void {
+    constructs_through_allocator<std::string>();
+    constructs_through_allocator<ThrowingMove>();
+}
+
+consteval auto test_iterators1() -> bool {
+    vector<int> vec;
+    for (int i = 0; i < 8; i++)
+        vec.emplace_back(i);
+
+    // standard algorithms
+    static_assert(std::contiguous_iterator<vector<int>::iterator>);
+    assert(std::ranges::equal(vec | std::views::reverse,
+                              std::views::iota(0, 8) | std::views::reverse));
+    assert(std::find(vec.cbegin(), vec.cend(), 3) == vec.begin() + 3);
+    assert(*vec.rbegin() == 7 && *(vec.crend() - 1) == 0);
+
+    // {0, 1, 2, 3, 4, 5, 6, 7} -> {0, 2, 3, 4, 5, 6, 7}
+    auto it = vec.erase(vec.begin() + 1);
+    assert(*it == 2 && vec.size() == 7);
+
+    // -> {0, 2, 6, 7}
+    it = vec.erase(vec.begin() + 2, vec.begin() + 5);
+    assert(*it == 6 && vec.size() == 4);
+
+    // -> {0, 7, 6}
+    it = vec.unordered_erase(vec.begin() + 1);
+    assert(*it == 7 && vec.size() == 3);
+
+    // -> {1, 0, 0, 7, 6, 1}, inserting elements of the container itself
+    vec.insert(vec.begin(), 1);
+    vec.insert(vec.end(), vec[0]);
+    vec.emplace(vec.begin() + 2, vec[1]);
+    int expected[] = {1, 0, 0, 7, 6, 1};
+    assert(std::ranges::equal(vec, expected));
+
+    // -> {7, 6}
+    assert(erase(vec, 1) == 2);
+    assert(erase_if(vec, [](int e) { return e == 0; }) == 2);
+    assert(vec.size() == 2 && vec[0] == 7 && vec[1] == 6);
+    return true;
+}
+
+auto test_iterators2() -> void {
+    // inserting an element of the container itself while it grows
+    vector<std::string> strs;
+    strs.emplace_back("a");
+    strs.emplace_back("b");
+    strs.insert(strs.begin(), strs[1]);
+    strs.emplace(strs.begin() + 1, strs[2]);
+    std::string expected_strs[] = {"b", "b", "a", "b"};
+    assert(std::ranges::equal(strs, expected_strs));
+
+    // -> {b, a, b} -> {b, a} -> {a}
+    auto it = strs.erase(strs.begin() + 1, strs.begin() + 2);
+    assert(*it == "a" && strs.size() == 3);
+    it = strs.unordered_erase(strs.begin());
+    assert(*it == "b" && strs.size() == 2 && strs[1] == "a");
+    assert(erase(strs, "b") == 1);
+    assert(strs.size() == 1 && strs[0] == "a");
+
+    // erase_if with a throwing predicate keeps the vector consistent
+    vector<unique_ptr<int>> vec;
+    for (int i = 0; i < 6; i++)
+        vec.emplace_back(make_unique<int>(i));
+    try {
+        erase_if(vec, [](const unique_ptr<int> &p) {
+            if (*p == 4)
+                throw 4;
+            return *p % 2 == 1;
+        });
+    } catch (int) {
+    }
+    int expected[] = {0, 2, 4, 5};
+    assert(vec.size() == 4);
+    for (int i = 0; i < 4; i++)
+        assert(*vec[i] == expected[i]);
+}
+
+// copy throws on the n-th copy, move may throw, so grow has to copy
+struct ThrowingCopy {
+    static inline int live = 0;
+    static inline int copies_until_throw = -1;
+    static inline int moves_until_throw = -1;
+    int value;
+
+    ThrowingCopy(int v) : value{v} { live++; }
+    ThrowingCopy(const ThrowingCopy &other) : value{other.value} {
+        if (copies_until_throw >= 0 && copies_until_throw-- == 0)
+            throw 0;
+        live++;
+    }
+    ThrowingCopy(ThrowingCopy &&other) noexcept(false) : value{other.value} {
+        if (moves_until_throw >= 0 && moves_until_throw-- == 0)
+            throw 0;
+        live++;
+    }
+    ~ThrowingCopy() { live--; }
+};
+
+template <class V> auto strong_guarantee() -> void {
+    {
+        V vec;
+        for (int i = 0; i < 4; i++)
+            vec.emplace_back(i);
+        auto cap = vec.capacity();
+        auto data = vec.data();
+
+        // grow fails on the third copy
+        ThrowingCopy::copies_until_throw = 2;
+        try {
+            vec.reserve(100);
+            assert(false);
+        } catch (int) {
+        }
+        assert(vec.capacity() == cap && vec.data() == data);
+        assert(vec.size() == 4);
+        for (int i = 0; i < 4; i++)
+            assert(vec[i].value == i);
+        assert(ThrowingCopy::live == 4);
+
+        // copy constructor fails on the second copy
+        ThrowingCopy::copies_until_throw = 1;
+        try {
+            V vec2(vec);
+            assert(false);
+        } catch (int) {
+        }
+        assert(ThrowingCopy::live == 4);
+        ThrowingCopy::copies_until_throw = -1;
+    }
+    assert(ThrowingCopy::live == 0);
+}
+
+// fixed_capacity_vector moves its elements, a throwing move leaks nothing
+auto throwing_move_fixed_capacity() -> void {
+    using V = fixed_capacity_vector<ThrowingCopy, 4>;
+    static_assert(!std::is_nothrow_move_constructible_v<V>);
+    static_assert(!std::is_nothrow_move_assignable_v<V>);
+    static_assert(std::is_nothrow_move_constructible_v<
+                  fixed_capacity_vector<std::string, 4>>);
+    {
+        V vec;
+        for (int i = 0; i < 4; i++)
+            vec.emplace_back(i);
+
+        ThrowingCopy::moves_until_throw = 2;
+        try {
+            V vec2(std::move(vec));
+            assert(false);
+        } catch (int) {
+        }
+        assert(vec.size() == 4 && ThrowingCopy::live == 4);
+
+        V vec3;
+        vec3.emplace_back(9);
+        ThrowingCopy::moves_until_throw = 1;
+        try {
+            vec3 = std::move(vec);
+            assert(false);
+        } catch (int) {
+        }
+        assert(vec.size() == 4 && vec3.size() == 1);
+        assert(ThrowingCopy::live == 5);
+        ThrowingCopy::moves_until_throw = -1;
+
+        vec3 = std::move(vec);
+        assert(vec.empty() && vec3.size() == 4 && vec3[3].value == 3);
+        assert(ThrowingCopy::live == 4);
+    }
+    assert(ThrowingCopy::live == 0);
+}
+
+// small_size_optimized_vector moves the elements in its buffer, a throwing
+// move leaks nothing and is not hidden behind noexcept
+auto throwing_move_small_vector() -> void {
+    using V = small_size_optimized_vector<ThrowingCopy, 4>;
+    static_assert(!std::is_nothrow_move_constructible_v<V>);
+    static_assert(!std::is_nothrow_move_assignable_v<V>);
+    static_assert(std::is_nothrow_move_constructible_v<
+                  small_size_optimized_vector<std::string, 4>>);
+    static_assert(std::is_nothrow_move_constructible_v<
+                  small_size_optimized_vector<unique_ptr<int>, 4>>);
+    {
+        V vec;
+        for (int i = 0; i < 4; i++)
+            vec.emplace_back(i);
+
+        ThrowingCopy::moves_until_throw = 2;
+        try {
+            V vec2(std::move(vec));
+            assert(false);
+        } catch (int) {
+        }
+        assert(vec.size() == 4 && ThrowingCopy::live == 4);
+
+        V vec3;
+        vec3.emplace_back(9);
+        ThrowingCopy::moves_until_throw = 1;
+        try {
+            vec3 = std::move(vec);
+            assert(false);
+        } catch (int) {
+        }
+        assert(vec.size() == 4 && vec3.size() == 1);
+        assert(ThrowingCopy::live == 5);
+        ThrowingCopy::moves_until_throw = -1;
+
+        vec3 = std::move(vec);
+        assert(vec.empty() && vec3.size() == 4 && vec3[3].value == 3);
+        assert(ThrowingCopy::live == 4);
+
+        // a heap block only changes hands
+        vec3.emplace_back(4);
+        ThrowingCopy::moves_until_throw = 0;
+        V vec4(std::move(vec3));
+        ThrowingCopy::moves_until_throw = -1;
+        assert(vec3.empty() && vec4.size() == 5 && vec4[4].value == 4);
+    }
+    assert(ThrowingCopy::live == 0);
+}
+
+auto test_exception_safety() -> void {
+    strong_guarantee<vector<ThrowingCopy>>();
+    strong_guarantee<small_size_optimized_vector<ThrowingCopy, 4>>();
+    throwing_move_fixed_capacity();
+    throwing_move_small_vector();
+}
+
 consteval auto test_fixed_capacity_vector1() -> bool {
     fixed_capacity_vector<int, 5> vec;
     assert(vec.empty());
@@ -89,6 +568,11 @@ consteval auto test_fixed_capacity_vector1() -> bool {
     vec2 = vec3;
     assert(vec2.size() == vec3.size());
     assert(vec2[0] == 23);
+
+    for (int i = 0; i < 5; i++)
+        assert(vec.try_emplace_back(i) != nullptr);
+    assert(vec.try_emplace_back(5) == nullptr);
+    assert(vec.size() == 5 && vec[4] == 4);
     return true;
 }
 
@@ -103,6 +587,38 @@ auto test_fixed_capacity_vector2() -> void {
     vec.emplace_back(std::move(s1));
 }
 
+auto test_fixed_capacity_vector3() -> void {
+    fixed_capacity_vector<unique_ptr<int>, 3> vec;
+    for (int i = 0; i < 3; i++)
+        assert(vec.try_emplace_back(make_unique<int>(i)) != nullptr);
+    assert(vec.try_emplace_back(make_unique<int>(3)) == nullptr);
+    assert(vec.size() == 3);
+
+    auto vec2 = std::move(vec);
+    assert(vec.empty() && vec2.size() == 3);
+    vec = std::move(vec2);
+    assert(vec2.empty());
+    for (int i = 0; i < 3; i++)
+        assert(*vec[i] == i);
+
+    fixed_capacity_vector<std::string, 4> strs;
+    strs.emplace_back(100, 'a');
+    strs.emplace_back("b");
+    auto strs2 = strs;
+    auto strs3 = std::move(strs);
+    assert(strs.empty());
+    assert(strs2.size() == 2 && strs2[0] == strs3[0] && strs3[1] == "b");
+    strs = strs3;
+    strs = strs;
+    assert(strs.size() == 2 && strs[0] == std::string(100, 'a'));
+
+    fixed_capacity_vector<double, 4> nums;
+    nums.emplace_back(1.5);
+    nums.emplace_back(2.5);
+    auto nums2 = nums;
+    assert(nums2.size() == 2 && nums2[1] == 2.5);
+}
+
 consteval auto test_small_vector1() -> bool {
     small_size_optimized_vector<int, 1> vec;
     assert(vec.capacity() == 1);
@@ -145,16 +661,179 @@ auto test_small_vector2() -> void {
     vec.emplace_back(std::move(s1));
 }
 
+auto test_small_vector3() -> void {
+    small_size_optimized_vector<unique_ptr<int>, 2> vec;
+    for (int i = 0; i < 100; i++)
+        vec.emplace_back(make_unique<int>(i));
+    for (int i = 0; i < 100; i++)
+        assert(*vec[i] == i);
+}
+
+// the insert and erase family shifts elements that own memory
+auto test_fixed_capacity_vector4() -> void {
+    using vec_t = fixed_capacity_vector<std::string, 6>;
+    static_assert(std::contiguous_iterator<vec_t::iterator>);
+    vec_t vec;
+    for (auto s : {"a", "b", "c", "d"})
+        vec.emplace_back(s);
+
+    // -> {d, a, a, b, c, d}, inserting elements of the container itself
+    vec.insert(vec.begin(), vec[3]);
+    vec.emplace(vec.begin() + 2, vec[1]);
+    std::string expected[] = {"d", "a", "a", "b", "c", "d"};
+    assert(std::ranges::equal(vec, expected));
+
+    // -> {d, b, c, d} -> {d, b, c} -> {b, c} -> {b}
+    auto it = vec.erase(vec.begin() + 1, vec.begin() + 3);
+    assert(*it == "b" && vec.size() == 4);
+    it = vec.unordered_erase(vec.begin());
+    assert(*it == "d" && vec.size() == 3);
+    assert(erase(vec, "d") == 1);
+    assert(erase_if(vec, [](const std::string &s) { return s == "c"; }) == 1);
+    assert(vec.size() == 1 && vec[0] == "b");
+}
+
+// compact layout
+static_assert(sizeof(fixed_capacity_vector<char, 15>) == 16);
+static_assert(sizeof(fixed_capacity_vector<int, 300>) == 1204);
+static_assert(sizeof(small_size_optimized_vector<char, 15>) == 24);
+static_assert(sizeof(small_size_optimized_vector<int, 4>) == 24);
+
+// swap moves the elements in the buffers, it throws if their moves do
+static_assert(std::is_nothrow_swappable_v<
+              small_size_optimized_vector<std::string, 4>>);
+static_assert(!std::is_nothrow_swappable_v<
+              small_size_optimized_vector<ThrowingCopy, 4>>);
+
+auto test_small_vector4() -> void {
+    small_size_optimized_vector<std::string, 2> vec;
+    vec.emplace_back("a");
+    vec.emplace_back(100, 'b');
+    assert(vec.capacity() == 2);
+    auto inline_copy = vec;
+
+    vec.emplace_back("c");
+    assert(vec.capacity() == 4 && vec.size() == 3);
+    assert(vec[0] == "a" && vec[1] == std::string(100, 'b') && vec[2] == "c");
+
+    auto heap_copy = vec;
+    auto moved = std::move(vec);
+    assert(vec.empty() && vec.capacity() == 2);
+    assert(moved.size() == 3 && moved[2] == "c");
+
+    vec = heap_copy;
+    assert(vec.size() == 3 && vec.capacity() == 3);
+    vec = std::move(inline_copy);
+    assert(vec.size() == 2 && vec[1] == std::string(100, 'b'));
+    assert(inline_copy.empty());
+
+    assert(erase(moved, "a") == 1);
+    assert(moved.size() == 2 && moved[0] == std::string(100, 'b'));
+}
+
+// insert leaves the buffer while one of its elements is the value
+auto test_small_vector5() -> void {
+    small_size_optimized_vector<std::string, 2> vec;
+    vec.emplace_back("a");
+    vec.emplace_back("b");
+    vec.insert(vec.begin(), vec[1]);
+    assert(vec.capacity() == 4);
+    vec.emplace(vec.begin() + 1, vec[2]);
+    std::string expected[] = {"b", "b", "a", "b"};
+    assert(std::ranges::equal(vec, expected));
+
+    auto it = vec.erase(vec.begin(), vec.begin() + 2);
+    assert(*it == "a" && vec.size() == 2);
+    it = vec.unordered_erase(vec.begin());
+    assert(*it == "b" && vec.size() == 1);
+    assert(erase_if(vec, [](const std::string &s) { return s == "b"; }) == 1);
+    assert(vec.empty());
+}
+
+// sizes picked so every combination of buffer and heap is swapped, element
+// by element since nothing is relocated bitwise in constant evaluation
+consteval auto test_small_vector6() -> bool {
+    int sizes[] = {0, 1, 3, 5, 8};
+    for (int n : sizes) {
+        for (int m : sizes) {
+            small_size_optimized_vector<int, 3> a;
+            small_size_optimized_vector<int, 3> b;
+            for (int i = 0; i < n; i++)
+                a.emplace_back(i);
+            for (int i = 0; i < m; i++)
+                b.emplace_back(100 + i);
+            swap(a, b);
+            assert(std::ranges::equal(a, std::views::iota(100, 100 + m)));
+            assert(std::ranges::equal(b, std::views::iota(0, n)));
+            a.swap(a);
+            assert(std::ranges::equal(a, std::views::iota(100, 100 + m)));
+        }
+    }
+    return true;
+}
+
+auto test_small_vector7() -> void {
+    // strings are not trivially relocatable, both in the buffer swaps the
+    // common prefix and moves the rest
+    int sizes[] = {0, 1, 3, 5, 8};
+    for (int n : sizes) {
+        for (int m : sizes) {
+            small_size_optimized_vector<std::string, 3> a;
+            small_size_optimized_vector<std::string, 3> b;
+            for (int i = 0; i < n; i++)
+                a.emplace_back(std::to_string(i));
+            for (int i = 0; i < m; i++)
+                b.emplace_back(std::to_string(100 + i));
+            swap(a, b);
+            assert(a.size() == static_cast<std::size_t>(m));
+            assert(b.size() == static_cast<std::size_t>(n));
+            for (int i = 0; i < m; i++)
+                assert(a[i] == std::to_string(100 + i));
+            for (int i = 0; i < n; i++)
+                assert(b[i] == std::to_string(i));
+        }
+    }
+
+    // unique_ptr is swapped bitwise
+    small_size_optimized_vector<unique_ptr<int>, 2> a;
+    small_size_optimized_vector<unique_ptr<int>, 2> b;
+    a.emplace_back(make_unique<int>(1));
+    for (int i = 0; i < 3; i++)
+        b.emplace_back(make_unique<int>(i));
+    std::swap(a, b);
+    assert(a.size() == 3 && *a[2] == 2);
+    assert(b.size() == 1 && *b[0] == 1);
+    auto c = std::move(b);
+    assert(b.empty() && *c[0] == 1);
+}
+
 auto main() -> int {
     std::cout << "test vector:\n";
     static_assert(test_vector1());
     test_vector2();
+    test_vector3();
+    static_assert(test_vector4());
+    static_assert(test_vector5());
+    test_vector6();
+    static_assert(test_vector7());
+    test_vector8();
+    test_vector9();
+    static_assert(test_iterators1());
+    test_iterators2();
+    test_exception_safety();
     std::cout << "test fixed_capacity_vector:\n";
     static_assert(test_fixed_capacity_vector1());
     test_fixed_capacity_vector2();
+    test_fixed_capacity_vector3();
+    test_fixed_capacity_vector4();
     std::cout << "test small_size_optimized_vector:\n";
     static_assert(test_small_vector1());
     test_small_vector2();
+    test_small_vector3();
+    test_small_vector4();
+    test_small_vector5();
+    static_assert(test_small_vector6());
+    test_small_vector7();
 }
 
 /*